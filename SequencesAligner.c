@@ -0,0 +1,455 @@
+/**
+ * @file SequencesAligner.c
+ * @brief Library scoring the global alignment of sequences (see SequencesAligner.h): the profile
+ * kernels, and the aligners scoring batches of pairs with them.
+ */
+
+// ------------------------------------------- includes -------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "SequencesAligner.h"
+#include "SequencesAlignerInternal.h"
+
+// ------------------------------------- constants definition -------------------------------------
+#define ALPHABET_SIZE 256
+#define PREALLOCATED_ALPHABET_SIZE 32
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MULTIVERSIONED_KERNELS 1
+#else
+#define MULTIVERSIONED_KERNELS 0
+#endif
+
+// ---------------------------------------- types definition --------------------------------------
+struct SequencesAligner
+{
+    /** The weight of a match. */
+    int m;
+    /** The weight of a mismatch. */
+    int s;
+    /** The weight of a gap. */
+    int g;
+    /** The index of the profile kernel in PROFILE_KERNEL_VARIANTS. */
+    int variant;
+    /** The code of every residue in the profile of the current query. */
+    unsigned char residueCodes[ALPHABET_SIZE];
+    /** The profile of the current query. */
+    QueryProfile profile;
+    /** The number of cells allocated for the profile scores. */
+    size_t profileCapacity;
+    /** The two rows of the kernel. */
+    int *rows;
+    /** The number of cells allocated for the rows. */
+    size_t rowsCapacity;
+};
+
+// -------------------------------------- functions declaration -----------------------------------
+#if MULTIVERSIONED_KERNELS
+/**
+ * @brief The profile kernel compiled for SSE4.1 (see scoreWithProfileTwoPass).
+ */
+int scoreWithProfileSse41(const QueryProfile *profile, const char *target, int targetLength,
+                          const unsigned char *residueCodes, int g, int *rows);
+/**
+ * @brief The profile kernel compiled for AVX2 (see scoreWithProfileTwoPass).
+ */
+int scoreWithProfileAvx2(const QueryProfile *profile, const char *target, int targetLength,
+                         const unsigned char *residueCodes, int g, int *rows);
+/**
+ * @brief The profile kernel compiled for AVX-512BW (see scoreWithProfileTwoPass).
+ */
+int scoreWithProfileAvx512(const QueryProfile *profile, const char *target, int targetLength,
+                           const unsigned char *residueCodes, int g, int *rows);
+#endif
+/**
+ * @brief A function that makes sure the workspace of an aligner has room for the profile of a query
+ * and its rows. The workspace only grows.
+ * @param aligner The aligner.
+ * @param profileCells The number of cells of the profile.
+ * @param rowsCells The number of cells of the rows.
+ * @return ALIGNER_SUCCESS or ALIGNER_OUT_OF_MEMORY.
+ */
+int reserveWorkspace(SequencesAligner *aligner, size_t profileCells, size_t rowsCells);
+/**
+ * @brief A function that codes the residues of a query (the residues missing from the query share
+ * the last code), and builds its profile in the workspace.
+ * @param aligner The aligner.
+ * @param query The query.
+ * @return ALIGNER_SUCCESS or ALIGNER_OUT_OF_MEMORY.
+ */
+int profileQuery(SequencesAligner *aligner, SequenceSpan query);
+/**
+ * @brief A function that checks a sequence span.
+ * @param span The span.
+ * @return 1 if the span is valid, 0 else.
+ */
+int isValidSpan(SequenceSpan span);
+/**
+ * @brief A function that checks whether two spans are the same sequence.
+ * @param first The first span.
+ * @param second The second span.
+ * @return 1 if the spans have the same residues pointer and length, 0 else.
+ */
+int isSameSpan(SequenceSpan first, SequenceSpan second);
+/**
+ * @brief A function that computes the maximum of three scores.
+ * @param n1 The first score.
+ * @param n2 The second score.
+ * @param n3 The third score.
+ * @return The maximum.
+ */
+static inline int maxOfThree(int n1, int n2, int n3)
+{
+    int maximum = n1 >= n2 ? n1 : n2;
+    return maximum >= n3 ? maximum : n3;
+}
+
+// ------------------------------------------- constants ------------------------------------------
+/**
+ * @brief The variants of the profile kernel, from the most portable to the widest.
+ */
+const ProfileKernelVariant PROFILE_KERNEL_VARIANTS[] = {
+    {"scalar", scoreWithProfile},
+#if MULTIVERSIONED_KERNELS
+    {"sse4.1", scoreWithProfileSse41},
+    {"avx2", scoreWithProfileAvx2},
+    {"avx512bw", scoreWithProfileAvx512},
+#endif
+};
+const int PROFILE_KERNEL_VARIANTS_COUNT = (int)(sizeof(PROFILE_KERNEL_VARIANTS) /
+                                                sizeof(PROFILE_KERNEL_VARIANTS[0]));
+
+// ------------------------------------------ functions -------------------------------------------
+int createSequencesAligner(int m, int s, int g, const char *isaName, int maximalLength,
+                           SequencesAligner **alignerAddress)
+{
+    if (alignerAddress == NULL)
+    {
+        return ALIGNER_INVALID_ARGUMENT;
+    }
+    *alignerAddress = NULL;
+    if (maximalLength < 0)
+    {
+        return ALIGNER_INVALID_ARGUMENT;
+    }
+    int variant = PROFILE_KERNEL_VARIANTS_COUNT - 1;
+    if (isaName == NULL)
+    {
+        while (variant > 0 && !isProfileKernelSupported(variant))
+        {
+            variant--;
+        }
+    }
+    else
+    {
+        while (variant >= 0 && strcmp(isaName, PROFILE_KERNEL_VARIANTS[variant].name) != 0)
+        {
+            variant--;
+        }
+        if (variant < 0 || !isProfileKernelSupported(variant))
+        {
+            return ALIGNER_UNSUPPORTED_ISA;
+        }
+    }
+    SequencesAligner *aligner = (SequencesAligner *)calloc(1, sizeof(SequencesAligner));
+    if (aligner == NULL)
+    {
+        return ALIGNER_OUT_OF_MEMORY;
+    }
+    aligner->m = m;
+    aligner->s = s;
+    aligner->g = g;
+    aligner->variant = variant;
+    if (reserveWorkspace(aligner, (size_t)PREALLOCATED_ALPHABET_SIZE * maximalLength,
+                         2 * ((size_t)maximalLength + 1)) != ALIGNER_SUCCESS)
+    {
+        freeSequencesAligner(aligner);
+        return ALIGNER_OUT_OF_MEMORY;
+    }
+    *alignerAddress = aligner;
+    return ALIGNER_SUCCESS;
+}
+
+void freeSequencesAligner(SequencesAligner *aligner)
+{
+    if (aligner == NULL)
+    {
+        return;
+    }
+    free(aligner->profile.scores);
+    free(aligner->rows);
+    free(aligner);
+}
+
+int scoreSequencesPair(SequencesAligner *aligner, SequenceSpan first, SequenceSpan second,
+                       int *scoreAddress)
+{
+    SequencePair pair = {first, second};
+    return scoreSequencesPairs(aligner, &pair, 1, scoreAddress);
+}
+
+int scoreSequencesPairs(SequencesAligner *aligner, const SequencePair *pairs, int pairsCount,
+                        int *scores)
+{
+    if (aligner == NULL || pairsCount < 0 || (pairsCount > 0 && (pairs == NULL || scores == NULL)))
+    {
+        return ALIGNER_INVALID_ARGUMENT;
+    }
+    ProfileKernel kernel = PROFILE_KERNEL_VARIANTS[aligner->variant].kernel;
+    int runStart = 0;
+    while (runStart < pairsCount)
+    {
+        int runEnd = runStart + 1;
+        while (runEnd < pairsCount && isSameSpan(pairs[runEnd].first, pairs[runStart].first))
+        {
+            runEnd++;
+        }
+        for (int pair = runStart; pair < runEnd; pair++)
+        {
+            if (!isValidSpan(pairs[pair].first) || !isValidSpan(pairs[pair].second))
+            {
+                return ALIGNER_INVALID_ARGUMENT;
+            }
+        }
+        // the score is symmetric, so a lone pair profiles its shorter sequence (fewer cells a row)
+        int swapped = runEnd - runStart == 1 &&
+                      pairs[runStart].second.length < pairs[runStart].first.length;
+        SequenceSpan query = swapped ? pairs[runStart].second : pairs[runStart].first;
+        int error = profileQuery(aligner, query);
+        if (error != ALIGNER_SUCCESS)
+        {
+            return error;
+        }
+        for (int pair = runStart; pair < runEnd; pair++)
+        {
+            SequenceSpan target = swapped ? pairs[pair].first : pairs[pair].second;
+            scores[pair] = kernel(&aligner->profile, target.residues, target.length,
+                                  aligner->residueCodes, aligner->g, aligner->rows);
+        }
+        runStart = runEnd;
+    }
+    return ALIGNER_SUCCESS;
+}
+
+const char *getAlignerIsaName(const SequencesAligner *aligner)
+{
+    return PROFILE_KERNEL_VARIANTS[aligner->variant].name;
+}
+
+const char *getAlignerErrorMessage(int error)
+{
+    switch (error)
+    {
+        case ALIGNER_SUCCESS:
+            return "Success";
+        case ALIGNER_INVALID_ARGUMENT:
+            return "Invalid argument";
+        case ALIGNER_OUT_OF_MEMORY:
+            return "Out of memory";
+        case ALIGNER_UNSUPPORTED_ISA:
+            return "Instruction set unknown or unsupported by the CPU";
+        default:
+            return "Unknown error";
+    }
+}
+
+int reserveWorkspace(SequencesAligner *aligner, size_t profileCells, size_t rowsCells)
+{
+    // the old contents are never needed, so the buffers are replaced rather than reallocated
+    if (profileCells > aligner->profileCapacity || aligner->profile.scores == NULL)
+    {
+        int *scores = (int *)malloc((profileCells > 0 ? profileCells : 1) * sizeof(int));
+        if (scores == NULL)
+        {
+            return ALIGNER_OUT_OF_MEMORY;
+        }
+        free(aligner->profile.scores);
+        aligner->profile.scores = scores;
+        aligner->profileCapacity = profileCells;
+    }
+    if (rowsCells > aligner->rowsCapacity)
+    {
+        int *rows = (int *)malloc(rowsCells * sizeof(int));
+        if (rows == NULL)
+        {
+            return ALIGNER_OUT_OF_MEMORY;
+        }
+        free(aligner->rows);
+        aligner->rows = rows;
+        aligner->rowsCapacity = rowsCells;
+    }
+    return ALIGNER_SUCCESS;
+}
+
+int profileQuery(SequencesAligner *aligner, SequenceSpan query)
+{
+    char seen[ALPHABET_SIZE] = {0};
+    int alphabetSize = 0;
+    for (int j = 0; j < query.length; j++)
+    {
+        unsigned char residue = (unsigned char)query.residues[j];
+        if (!seen[residue])
+        {
+            seen[residue] = 1;
+            aligner->residueCodes[residue] = (unsigned char)alphabetSize++;
+        }
+    }
+    if (alphabetSize < ALPHABET_SIZE)
+    {
+        // every residue missing from the query mismatches all of it, so they share one code
+        for (int residue = 0; residue < ALPHABET_SIZE; residue++)
+        {
+            if (!seen[residue])
+            {
+                aligner->residueCodes[residue] = (unsigned char)alphabetSize;
+            }
+        }
+        alphabetSize++;
+    }
+    int error = reserveWorkspace(aligner, (size_t)alphabetSize * query.length,
+                                 2 * ((size_t)query.length + 1));
+    if (error != ALIGNER_SUCCESS)
+    {
+        return error;
+    }
+    aligner->profile.length = query.length;
+    buildQueryProfile(query.residues, query.length, aligner->residueCodes, alphabetSize,
+                      aligner->m, aligner->s, &aligner->profile);
+    return ALIGNER_SUCCESS;
+}
+
+int isValidSpan(SequenceSpan span)
+{
+    return span.length >= 0 && (span.residues != NULL || span.length == 0);
+}
+
+int isSameSpan(SequenceSpan first, SequenceSpan second)
+{
+    return first.residues == second.residues && first.length == second.length;
+}
+
+void buildQueryProfile(const char *query, int length, const unsigned char *residueCodes,
+                       int alphabetSize, int m, int s, QueryProfile *profile)
+{
+    for (int code = 0; code < alphabetSize; code++)
+    {
+        int *scores = profile->scores + (size_t)code * length;
+        for (int j = 0; j < length; j++)
+        {
+            scores[j] = residueCodes[(unsigned char)query[j]] == code ? m : s;
+        }
+    }
+}
+
+int scoreWithProfile(const QueryProfile *profile, const char *target, int targetLength,
+                     const unsigned char *residueCodes, int g, int *row)
+{
+    int length = profile->length;
+    for (int j = 0; j <= length; j++)
+    {
+        row[j] = j * g;
+    }
+    for (int i = 0; i < targetLength; i++)
+    {
+        const int *scores = profile->scores +
+                            (size_t)residueCodes[(unsigned char)target[i]] * length;
+        int diagonal = row[0];
+        row[0] = (i + 1) * g;
+        for (int j = 1; j <= length; j++)
+        {
+            int up = row[j];
+            row[j] = maxOfThree(diagonal + scores[j - 1], row[j - 1] + g, up + g);
+            diagonal = up;
+        }
+    }
+    return row[length];
+}
+
+#if MULTIVERSIONED_KERNELS
+/**
+ * @brief The body of the vectorizable profile kernels. Every row is computed in two passes: the
+ * diagonal and vertical moves depend only on the previous row, so the first pass vectorizes; the
+ * horizontal moves are then propagated by a scalar scan. The body is inlined into one function per
+ * instruction set, so the compiler vectorizes the first pass for each of them.
+ * @param profile The query profile.
+ * @param target The target sequence.
+ * @param targetLength The length of the target.
+ * @param residueCodes The code of every residue.
+ * @param g The weight of a gap.
+ * @param rows A buffer for two rows (of profile->length + 1 cells each).
+ * @return The score of the alignment of the query to the target.
+ */
+static inline __attribute__((always_inline))
+int scoreWithProfileTwoPass(const QueryProfile *profile, const char *target, int targetLength,
+                            const unsigned char *residueCodes, int g, int *rows)
+{
+    int length = profile->length;
+    int *previous = rows, *current = rows + length + 1;
+    for (int j = 0; j <= length; j++)
+    {
+        previous[j] = j * g;
+    }
+    for (int i = 0; i < targetLength; i++)
+    {
+        const int *restrict scores = profile->scores +
+                                     (size_t)residueCodes[(unsigned char)target[i]] * length;
+        const int *restrict above = previous;
+        int *restrict cells = current;
+        for (int j = 1; j <= length; j++)
+        {
+            int firstMatchScore = above[j - 1] + scores[j - 1];
+            int thirdMatchScore = above[j] + g;
+            cells[j] = firstMatchScore > thirdMatchScore ? firstMatchScore : thirdMatchScore;
+        }
+        cells[0] = (i + 1) * g;
+        for (int j = 1; j <= length; j++)
+        {
+            int secondMatchScore = cells[j - 1] + g;
+            cells[j] = secondMatchScore > cells[j] ? secondMatchScore : cells[j];
+        }
+        previous = current;
+        current = current == rows ? rows + length + 1 : rows;
+    }
+    return previous[length];
+}
+
+__attribute__((target("sse4.1")))
+int scoreWithProfileSse41(const QueryProfile *profile, const char *target, int targetLength,
+                          const unsigned char *residueCodes, int g, int *rows)
+{
+    return scoreWithProfileTwoPass(profile, target, targetLength, residueCodes, g, rows);
+}
+
+__attribute__((target("avx2")))
+int scoreWithProfileAvx2(const QueryProfile *profile, const char *target, int targetLength,
+                         const unsigned char *residueCodes, int g, int *rows)
+{
+    return scoreWithProfileTwoPass(profile, target, targetLength, residueCodes, g, rows);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+int scoreWithProfileAvx512(const QueryProfile *profile, const char *target, int targetLength,
+                           const unsigned char *residueCodes, int g, int *rows)
+{
+    return scoreWithProfileTwoPass(profile, target, targetLength, residueCodes, g, rows);
+}
+#endif
+
+int isProfileKernelSupported(int variant)
+{
+#if MULTIVERSIONED_KERNELS
+    // __builtin_cpu_supports reads cpuid, and only takes literal feature names
+    __builtin_cpu_init();
+    switch (variant)
+    {
+        case 1:
+            return __builtin_cpu_supports("sse4.1");
+        case 2:
+            return __builtin_cpu_supports("avx2");
+        case 3:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        default:
+            break;
+    }
+#endif
+    return variant == 0;
+}
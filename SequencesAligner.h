@@ -0,0 +1,106 @@
+/**
+ * @file SequencesAligner.h
+ * @brief Library scoring the global alignment of sequences, for programs that compare sequences
+ * in-process. An aligner holds the weights and the workspace of the scoring (the query profile and
+ * the rows), so scoring a batch of pairs allocates nothing once the workspace is large enough. The
+ * sequences are given as (pointer, length) spans and are never copied. Errors are returned as
+ * codes, the library never exits or prints.
+ *
+ * An aligner isn't thread safe: every thread scores with an aligner of its own.
+ */
+
+#ifndef SEQUENCES_ALIGNER_H
+#define SEQUENCES_ALIGNER_H
+
+// ------------------------------------- constants definition -------------------------------------
+#define ALIGNER_SUCCESS 0
+#define ALIGNER_INVALID_ARGUMENT 1
+#define ALIGNER_OUT_OF_MEMORY 2
+#define ALIGNER_UNSUPPORTED_ISA 3
+
+// ---------------------------------------- types definition --------------------------------------
+/**
+ * @brief A sequence given by its residues and its length, without a terminating NUL.
+ */
+typedef struct SequenceSpan
+{
+    /** The residues (may be NULL if the length is 0). */
+    const char *residues;
+    /** The number of residues. */
+    int length;
+} SequenceSpan;
+
+/**
+ * @brief A pair of sequences to score.
+ */
+typedef struct SequencePair
+{
+    /** The first sequence. */
+    SequenceSpan first;
+    /** The second sequence. */
+    SequenceSpan second;
+} SequencePair;
+
+/**
+ * @brief An aligner: the weights, the chosen profile kernel and the workspace (opaque).
+ */
+typedef struct SequencesAligner SequencesAligner;
+
+// -------------------------------------- functions declaration -----------------------------------
+/**
+ * @brief A function that creates an aligner, with a workspace for sequences of up to a length.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param isaName The instruction set of the profile kernel, or NULL for the widest one the CPU
+ * supports.
+ * @param maximalLength The length of the longest sequence expected (longer ones grow the
+ * workspace).
+ * @param alignerAddress A pointer to the aligner created (NULL on failure).
+ * @return ALIGNER_SUCCESS, ALIGNER_INVALID_ARGUMENT, ALIGNER_OUT_OF_MEMORY or
+ * ALIGNER_UNSUPPORTED_ISA.
+ */
+int createSequencesAligner(int m, int s, int g, const char *isaName, int maximalLength,
+                           SequencesAligner **alignerAddress);
+/**
+ * @brief A function that frees an aligner and its workspace.
+ * @param aligner The aligner (may be NULL).
+ */
+void freeSequencesAligner(SequencesAligner *aligner);
+/**
+ * @brief A function that scores the global alignment of two sequences.
+ * @param aligner The aligner.
+ * @param first The first sequence.
+ * @param second The second sequence.
+ * @param scoreAddress A pointer to the score.
+ * @return ALIGNER_SUCCESS, ALIGNER_INVALID_ARGUMENT or ALIGNER_OUT_OF_MEMORY.
+ */
+int scoreSequencesPair(SequencesAligner *aligner, SequenceSpan first, SequenceSpan second,
+                       int *scoreAddress);
+/**
+ * @brief A function that scores the global alignment of a batch of pairs. Consecutive pairs with
+ * the same first sequence (the same residues pointer and length) share its profile, so a query
+ * scored against many targets builds its profile once.
+ * @param aligner The aligner.
+ * @param pairs The pairs.
+ * @param pairsCount The number of pairs.
+ * @param scores The array to write the score of every pair to.
+ * @return ALIGNER_SUCCESS, ALIGNER_INVALID_ARGUMENT or ALIGNER_OUT_OF_MEMORY (the scores of the
+ * pairs before the failing one are written).
+ */
+int scoreSequencesPairs(SequencesAligner *aligner, const SequencePair *pairs, int pairsCount,
+                        int *scores);
+/**
+ * @brief A function that returns the name of the instruction set of the kernel of an aligner.
+ * @param aligner The aligner.
+ * @return The name, as given to createSequencesAligner.
+ */
+const char *getAlignerIsaName(const SequencesAligner *aligner);
+/**
+ * @brief A function that returns the message of an error code.
+ * @param error The error code.
+ * @return The message.
+ */
+const char *getAlignerErrorMessage(int error);
+
+#endif // SEQUENCES_ALIGNER_H
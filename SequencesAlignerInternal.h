@@ -0,0 +1,84 @@
+/**
+ * @file SequencesAlignerInternal.h
+ * @brief The profile kernels the alignment library scores with, for the sequences comparison
+ * program (which schedules them itself) and the library's tests. They are not part of the library
+ * API (see SequencesAligner.h), and may change with it.
+ */
+
+#ifndef SEQUENCES_ALIGNER_INTERNAL_H
+#define SEQUENCES_ALIGNER_INTERNAL_H
+
+// ---------------------------------------- types definition --------------------------------------
+/**
+ * @brief The scores of a query against every residue: for each residue code, the score of
+ * aligning it to each position of the query. It is built once per query and reused for every
+ * target.
+ */
+typedef struct QueryProfile
+{
+    /** The length of the query. */
+    int length;
+    /** The scores, length per residue code. */
+    int *scores;
+} QueryProfile;
+
+/**
+ * @brief A kernel scoring a target against a query profile. Every variant is given a buffer of at
+ * least two rows of profile->length + 1 cells, which it may use in whole or in part.
+ */
+typedef int (*ProfileKernel)(const QueryProfile *profile, const char *target, int targetLength,
+                             const unsigned char *residueCodes, int g, int *rows);
+
+/**
+ * @brief A variant of the profile kernel, compiled for an instruction set.
+ */
+typedef struct ProfileKernelVariant
+{
+    /** The name of the instruction set, as given to --isa. */
+    const char *name;
+    /** The kernel. */
+    ProfileKernel kernel;
+} ProfileKernelVariant;
+
+// ------------------------------------------- constants ------------------------------------------
+/**
+ * @brief The variants of the profile kernel, from the most portable to the widest.
+ */
+extern const ProfileKernelVariant PROFILE_KERNEL_VARIANTS[];
+extern const int PROFILE_KERNEL_VARIANTS_COUNT;
+
+// -------------------------------------- functions declaration -----------------------------------
+/**
+ * @brief A function that builds the profile of a query.
+ * @param query The query.
+ * @param length The length of the query.
+ * @param residueCodes The code of every residue.
+ * @param alphabetSize The number of residue codes.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param profile The profile to fill (its scores must have alphabetSize * length cells).
+ */
+void buildQueryProfile(const char *query, int length, const unsigned char *residueCodes,
+                       int alphabetSize, int m, int s, QueryProfile *profile);
+/**
+ * @brief A function that scores a target against a query profile, keeping one row of the table
+ * (the rows run over the target and the row cells over the query).
+ * @param profile The query profile.
+ * @param target The target sequence.
+ * @param targetLength The length of the target.
+ * @param residueCodes The code of every residue.
+ * @param g The weight of a gap.
+ * @param row A buffer of at least two rows of profile->length + 1 cells (the ProfileKernel
+ * contract), of which only the first row is used.
+ * @return The score of the alignment of the query to the target.
+ */
+int scoreWithProfile(const QueryProfile *profile, const char *target, int targetLength,
+                     const unsigned char *residueCodes, int g, int *row);
+/**
+ * @brief A function that checks whether the CPU supports the instruction set of a kernel variant.
+ * @param variant The index of the variant in the variants table.
+ * @return 1 if the variant can run, 0 else.
+ */
+int isProfileKernelSupported(int variant);
+
+#endif // SEQUENCES_ALIGNER_INTERNAL_H
@@ -8,10 +8,34 @@
  */
 
 // ------------------------------------------- includes -------------------------------------------
+#define _POSIX_C_SOURCE 200809L
+// for syscall(), since perf_event_open has no libc wrapper
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <limits.h>
+#include <sys/resource.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "SequencesAligner.h"
+#include "SequencesAlignerInternal.h"
 
 // ------------------------------------- constants definition -------------------------------------
 #define NUMBER_OF_ARGUMENTS 5
@@ -23,9 +47,800 @@
 #define DECIMAL_BASE 10
 #define MAXIMAL_NUMBER_OF_SEQUENCES 100
 #define MAXIMAL_ROW_LENGTH 101
+#define DEFAULT_KMER_LENGTH 12
+#define DEFAULT_WINDOW_LENGTH 8
+#define DEFAULT_MINIMAL_SHARED_SEEDS 2
+#define MAXIMAL_KMER_LENGTH 32
+#define KMER_HASH_BASE 0x100000001b3ULL
+#define NANOSECONDS_IN_MILLISECOND 1e6
+#define NANOSECONDS_IN_SECOND 1000000000LL
+#define PERCENT 100.0
+#define CHAINING_LOOKBACK 64
+#define SEQUENCE_HASH_SEED 0x27d4eb2f165667c5ULL
+#define SEQUENCE_HASH_PRIME1 0x9e3779b185ebca87ULL
+#define SEQUENCE_HASH_PRIME2 0xc2b2ae3d27d4eb4fULL
+#define SEQUENCE_HASH_WORD_ROTATION 31
+#define SEQUENCE_HASH_ACCUMULATOR_ROTATION 27
+#define SEQUENCE_HASH_BYTE_ROTATION 11
+#define BITS_IN_WORD 64
+#define DEFAULT_CACHE_CAPACITY 65536
+#define CACHE_PROBE_LIMIT 16
+#define CACHE_MAGIC 0x3265686361633230ULL
+#define CACHE_VERSION 1
+#define CACHE_FILE_PERMISSIONS 0644
+#define MATRIX_HEADER_FIELDS 5
+#define MATRIX_SIGNATURE "#02n"
+#define MATRIX_HASHES_TITLE "#hashes"
+#define MATRIX_MISSING_SCORE "NA"
+#define MATRIX_DIAGONAL "-"
+#define HEXADECIMAL_BASE 16
+#define MAXIMAL_SWEEP_WEIGHTS 64
+#define SWEEP_LANES 8
+#define SWEEP_VECTOR_BYTES 32
+#define WEIGHTS_SEPARATOR ','
+#define QUERY_BLOCK_BYTES (256 * 1024)
+#define ALPHABET_SIZE 256
+#define TILE_L2_BYTES (256 * 1024)
+#define TILE_L3_BYTES (8 * 1024 * 1024)
+#define ISA_ENVIRONMENT_VARIABLE "COMPARE_SEQUENCES_ISA"
+#define DEFAULT_WIDEST_ISA "avx2"
+#define AUTO_BUCKETS 5
+#define AUTO_FIRST_BUCKET_CELLS 10000LL
+#define AUTO_BUCKET_FACTOR 10
+#define AUTO_SAMPLES_PER_BUCKET 3
+#define AUTO_BUCKET_BUDGET_NANOSECONDS 20000000LL
+#define ENGINE_TABLE 0
+#define ENGINE_ROLLING_ROW 1
+#define ENGINE_FIRST_PROFILE 2
+#define PLAN_SIGNATURE "#02n-plan"
+#define MAXIMAL_ENGINE_NAME_LENGTH 32
+#define DIRECTION_DIAGONAL 0
+#define DIRECTION_UP 1
+#define DIRECTION_LEFT 2
+#define DIRECTION_TIE 3
+#define DIRECTION_BITS 2
+#define DIRECTION_MASK 3
+#define DIRECTIONS_PER_BYTE 4
+#define GAP_CHAR '-'
+#define BYTES_IN_MEGABYTE (1024 * 1024)
+#define DEFAULT_TRACEBACK_MEMORY 1024
+#define DEFAULT_SCRATCH_DIRECTORY "/tmp"
+#define SCRATCH_FILE_TEMPLATE "02n-scratch-XXXXXX"
+#define SCRATCH_BLOCK_BYTES (8 * 1024 * 1024)
+#define STRATEGY_FULL_TABLE 0
+#define STRATEGY_DIRECTIONS 1
+#define STRATEGY_OUT_OF_CORE 2
+#define STRATEGY_HIRSCHBERG 3
+#define STRATEGY_SCORE_ONLY 4
+#define STRATEGIES_COUNT 5
+#define HIRSCHBERG_BASE_BYTES (64 * 1024)
+#define OUT_OF_CORE_MINIMAL_SEGMENT_ROWS 64
+#define DEFAULT_THREADS 1
+#define MAXIMAL_THREADS 256
+#define MAXIMAL_SHARDS 4096
+#define SHARD_SIGNATURE "#02n-shard"
+#define SHARD_END "#02n-end"
+#define SHARD_HEADER_FIELDS 11
+#define SHARD_FIELD_INDEX 0
+#define SHARD_FIELD_COUNT 1
+#define SHARD_FIELD_HASH 5
+#define SHARD_FIELD_FIRST_PAIR 6
+#define SHARD_FIELD_END_PAIR 7
+#define SHARD_FIELD_PAIRS 8
+#define SHARD_FIELD_MODE 9
+#define MERGE_COMMAND "merge"
+#define MERGE_BUFFER_BYTES (64 * 1024)
+#define DEFAULT_CHECKPOINT_INTERVAL 60
+#define CHECKPOINT_OUTPUT_SUFFIX ".out"
+#define CHECKPOINT_JOURNAL_SUFFIX ".journal"
+#define JOURNAL_SIGNATURE "#02n-journal"
+#define JOURNAL_FINISHED "finished"
+#define JOURNAL_SCORE "score"
+#define JOURNAL_LINE_LENGTH 128
+#define PROGRESS_INTERVAL_NANOSECONDS 1000000000LL
+#define CACHE_LINE_BYTES 64
+#define CELLS_IN_GIGACELL 1e9
+#define PHASE_NONE -1
+#define PHASE_PARSE 0
+#define PHASE_SCHEDULE 1
+#define PHASE_ALIGN 2
+#define PHASE_OUTPUT 3
+#define PHASES_COUNT 4
+#define PAIR_SOURCE_NONE 0
+#define PAIR_SOURCE_COMPUTED 1
+#define PAIR_SOURCE_MEMO 2
+#define PAIR_SOURCE_PRUNED 3
+#define PAIR_SOURCES_COUNT 4
+#define PRECISION_TIER "int32"
+#define TRACE_BUFFER_EVENTS 65536
+#define NANOSECONDS_IN_MICROSECOND 1000.0
+#ifdef __linux__
+#define PERF_COUNTERS_SUPPORTED 1
+#else
+#define PERF_COUNTERS_SUPPORTED 0
+#endif
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_L1_MISSES 2
+#define PERF_LLC_MISSES 3
+#define PERF_BRANCH_MISSES 4
+#define PERF_COUNTERS_COUNT 5
+#define CELLS_IN_KILOCELL 1000.0
+#define BENCH_MINIMAL_NANOSECONDS 100000000LL
+#define BENCH_MAXIMAL_REPETITIONS 1000
+#define MEMORY_SEQUENCES 0
+#define MEMORY_NAMES 1
+#define MEMORY_WORKSPACE 2
+#define MEMORY_OUTPUT 3
+#define MEMORY_CACHES 4
+#define MEMORY_SUBSYSTEMS_COUNT 5
+#define MEMORY_SERIES_INTERVAL_NANOSECONDS 100000000LL
+#define BYTES_IN_KILOBYTE 1024
+#define SERVE_MAXIMAL_CONNECTIONS 64
+#define SERVE_BACKLOG 64
+#define SERVE_PREFIX_BYTES 4
+#define SERVE_MAXIMAL_QUERY_LENGTH (64 * 1024 * 1024)
 
 const char HEADER_LINE_FIRST_CHAR = '>';
 const char MEMORY_ALLOCATION_FAILED_MESSAGE[] = "Error - memory allocation failed\n";
+const char OPTION_PREFIX[] = "--";
+const char *const STRATEGY_NAMES[STRATEGIES_COUNT] = {"full table", "2-bit directions",
+                                                      "out-of-core", "Hirschberg", "score only"};
+const char *const MEMORY_SUBSYSTEM_NAMES[MEMORY_SUBSYSTEMS_COUNT] = {"sequences", "names",
+                                                                    "workspace", "output",
+                                                                    "caches"};
+const char *const PHASE_NAMES[PHASES_COUNT] = {"parse", "schedule", "align", "output"};
+const char *const PAIR_SOURCE_NAMES[PAIR_SOURCES_COUNT] = {"none", "computed", "memo", "pruned"};
+
+// ---------------------------------------- types definition --------------------------------------
+/**
+ * @brief The optional settings of the program, given after the four mandatory arguments.
+ */
+typedef struct ProgramOptions
+{
+    /** Whether to compare only the pairs that share enough minimizers (--prefilter). */
+    int prefilter;
+    /** The length of the k-mers the minimizers are chosen from (--kmer). */
+    int kmerLength;
+    /** The number of consecutive k-mers a minimizer is chosen from (--window). */
+    int windowLength;
+    /** The minimal number of shared minimizers of a candidate pair (--min-seeds). */
+    int minimalSharedSeeds;
+    /** Whether to score the rejected pairs too, to measure the prefilter (--prefilter-check). */
+    int prefilterCheck;
+    /** The score from which a pair counts as related when measuring the prefilter. */
+    int prefilterCheckThreshold;
+    /** Whether to align only the gaps between chained k-mer anchors (--anchored). */
+    int anchored;
+    /** Whether to compare the anchored score with the exact one (--anchored-check). */
+    int anchoredCheck;
+    /** Whether to align every pair even if its sequences are duplicates (--no-dedup). */
+    int noDeduplication;
+    /** The path of the persistent pair scores cache, or NULL for no cache (--cache). */
+    char *cacheFileName;
+    /** The number of entries of a newly created cache file (--cache-size). */
+    int cacheCapacity;
+    /** The path to write the scores matrix to, or NULL (--matrix-out). */
+    char *matrixOutputFileName;
+    /** The path of the scores matrix of a previous run to reuse, or NULL (--previous). */
+    char *previousMatrixFileName;
+    /** Whether to score a sequence growing on the standard input against the file (--extend). */
+    int extend;
+    /** The number of weight triples to sweep, besides the mandatory one (--weights). */
+    int sweepWeightsCount;
+    /** The (m, s, g) weight triples to sweep, the mandatory one first. */
+    int sweepWeights[MAXIMAL_SWEEP_WEIGHTS + 1][3];
+    /** The path of the query sequences file, replacing the mandatory one (--query). */
+    char *queryFileName;
+    /** The path of a database sequences file to compare the queries to, or NULL (--db). */
+    char *databaseFileName;
+    /** Whether to traverse the pairs in cache sized blocks of similar lengths (--tiled). */
+    int tiled;
+    /** The instruction set of the kernels to force, or NULL to detect it (--isa). */
+    char *isaName;
+    /** Whether to pick the fastest engine per length bucket by timing a sample (--auto). */
+    int autoTune;
+    /** The path of the engines plan to load, or to save after calibrating, or NULL (--plan). */
+    char *planFileName;
+    /** Whether to print an optimal alignment of every pair under its score (--alignment). */
+    int alignment;
+    /** The megabytes of directions a traceback may keep in memory (--traceback-memory). */
+    int tracebackMemory;
+    /** The directory of the traceback scratch files (--scratch-dir). */
+    char *scratchDirectory;
+    /** The megabytes a traceback scratch file may take, or 0 for no limit (--scratch-limit). */
+    int scratchLimit;
+    /** The megabytes the pairs aligned at once may take, or 0 for no limit (--mem-limit). */
+    int memoryLimit;
+    /** The number of threads aligning pairs (--threads). */
+    int threads;
+    /** The path of a file of the pairs to compare instead of all of them, or NULL (--pairs). */
+    char *pairsFileName;
+    /** The 1-based index of the shard of the pairs to compare, or 0 for all of them (--shard). */
+    int shardIndex;
+    /** The number of shards the pairs are partitioned into (--shard). */
+    int shardsCount;
+    /** The prefix of the output and journal files of a checkpointed run, or NULL (--checkpoint). */
+    char *checkpointPrefix;
+    /** The seconds between two checkpoints (--checkpoint-interval). */
+    int checkpointInterval;
+    /** Whether to resume the checkpointed run from its journal (--resume). */
+    int resume;
+    /** Whether to report the progress of the run every second (--progress). */
+    int progress;
+    /** The path of the status file to rewrite with the progress, or NULL for stderr. */
+    char *progressFileName;
+    /** Whether to report the live and peak memory of every subsystem at exit (--mem-report). */
+    int memoryReport;
+    /** The path of the file to sample the memory of every subsystem to, or NULL (--mem-series). */
+    char *memorySeriesFileName;
+    /** The path of the Unix socket to serve the scores of queries on, or NULL (--serve). */
+    char *serveSocketName;
+    /** Whether to benchmark every engine on every bucket of pair sizes instead (--bench). */
+    int bench;
+    /** Whether to read the hardware performance counters around the scoring (--perf). */
+    int perf;
+    /** The path of the Chrome trace file to write at exit, or NULL (--trace). */
+    char *traceFileName;
+    /** The path of the file to write the phase and pair statistics to, or NULL (--stats). */
+    char *statsFileName;
+    /** The nanoseconds spent reading the sequences (measured by main, not an option). */
+    long long parseTime;
+} ProgramOptions;
+
+/**
+ * @brief A group of SWEEP_LANES integers processed together, one lane per weight triple.
+ */
+typedef int32_t SweepVector __attribute__((vector_size(SWEEP_VECTOR_BYTES)));
+
+/**
+ * @brief A minimizer of a sequence, used as a seed by the prefilter index.
+ */
+typedef struct Seed
+{
+    /** The hash of the minimizer's k-mer. */
+    uint64_t hash;
+    /** The index of the sequence the minimizer was taken from. */
+    int sequenceIndex;
+} Seed;
+
+/**
+ * @brief A k-mer of a sequence and its position, used to look up anchors.
+ */
+typedef struct KmerPosition
+{
+    /** The hash of the k-mer. */
+    uint64_t hash;
+    /** The position of the k-mer in the sequence. */
+    int position;
+} KmerPosition;
+
+/**
+ * @brief The header of a persistent pair scores cache file.
+ */
+typedef struct ScoreCacheHeader
+{
+    /** The magic number identifying a cache file. */
+    uint64_t magic;
+    /** The version of the file layout. */
+    uint32_t version;
+    /** The number of entries in the file. */
+    uint32_t capacity;
+    /** A counter advanced on every access, used as the time of last use of the entries. */
+    uint64_t clock;
+} ScoreCacheHeader;
+
+/**
+ * @brief An entry of a persistent pair scores cache file. An entry whose lastUse is 0 is empty.
+ */
+typedef struct ScoreCacheEntry
+{
+    /** The content hash of the first sequence. */
+    uint64_t hash1;
+    /** The content hash of the second sequence. */
+    uint64_t hash2;
+    /** The length of the first sequence. */
+    int32_t length1;
+    /** The length of the second sequence. */
+    int32_t length2;
+    /** The weight of a match. */
+    int32_t m;
+    /** The weight of a mismatch. */
+    int32_t s;
+    /** The weight of a gap. */
+    int32_t g;
+    /** The scoring mode (0 for the exact score, the k-mer length for the anchored score). */
+    int32_t mode;
+    /** The score of the pair. */
+    int32_t score;
+    /** Padding, keeping lastUse aligned. */
+    int32_t reserved;
+    /** The cache clock at the last use of the entry. */
+    uint64_t lastUse;
+} ScoreCacheEntry;
+
+/**
+ * @brief A persistent pair scores cache: a hash table in a memory mapped file, shared between
+ * processes with file locks.
+ */
+typedef struct ScoreCache
+{
+    /** The file descriptor of the cache file. */
+    int fileDescriptor;
+    /** The mapped file. */
+    ScoreCacheHeader *header;
+    /** The entries of the table, following the header. */
+    ScoreCacheEntry *entries;
+    /** The size of the mapping in bytes. */
+    size_t mappedSize;
+    /** The number of lookups answered from the cache. */
+    int hits;
+    /** The number of lookups that missed the cache. */
+    int misses;
+} ScoreCache;
+
+/**
+ * @brief The scores matrix of a previous run, read from its TSV file.
+ */
+typedef struct PreviousResults
+{
+    /** The number of sequences of the previous run. */
+    int numberOfSequences;
+    /** The names of the sequences of the previous run. */
+    char **names;
+    /** The content hashes of the sequences of the previous run. */
+    uint64_t *hashes;
+    /** The scores of the previous run (numberOfSequences squared). */
+    int *scores;
+    /** Whether every score of the previous run was computed (pairs rejected by the prefilter
+     * weren't). */
+    char *scoreKnown;
+} PreviousResults;
+
+/**
+ * @brief A sequence of the run and its length, sorted by length when the pairs are tiled.
+ */
+typedef struct SequenceLength
+{
+    /** The length of the sequence. */
+    int length;
+    /** The index of the sequence in the sequences array. */
+    int index;
+} SequenceLength;
+
+/**
+ * @brief What is known of how the score of a pair was found, for --stats.
+ */
+typedef struct PairStatistics
+{
+    /** The nanoseconds spent computing the score, or 0 if it wasn't computed. */
+    long long nanoseconds;
+    /** The name of the kernel or strategy that computed the score. */
+    char kernel[MAXIMAL_ENGINE_NAME_LENGTH];
+    /** Where the score came from (PAIR_SOURCE_*). */
+    char source;
+} PairStatistics;
+
+/**
+ * @brief The memory allocated by a subsystem (or by all of them), for --mem-report.
+ */
+typedef struct MemoryAccount
+{
+    /** The bytes allocated and not freed yet. */
+    long long live;
+    /** The most bytes that were live at once. */
+    long long peak;
+    /** The number of allocations. */
+    long long allocations;
+} MemoryAccount;
+
+/**
+ * @brief The header of a tracked allocation, in front of the bytes returned. The union keeps the
+ * bytes after it aligned for any type, like malloc's.
+ */
+typedef union MemoryHeader
+{
+    struct
+    {
+        /** The bytes requested. */
+        size_t bytes;
+        /** The subsystem charged (MEMORY_*). */
+        int subsystem;
+    } allocation;
+    /** Unused, for the alignment. */
+    long double alignment;
+} MemoryHeader;
+
+/**
+ * @brief The sampling of the memory of the subsystems to a file (--mem-series).
+ */
+typedef struct MemorySeries
+{
+    /** The file of the samples, or NULL if there is no sampling. */
+    FILE *file;
+    /** The thread taking the samples. */
+    pthread_t thread;
+    /** Guards stopped. */
+    pthread_mutex_t lock;
+    /** Signaled to stop the sampling. */
+    pthread_cond_t stop;
+    /** Whether the sampling has to stop. */
+    int stopped;
+    /** The time the sampling started, in nanoseconds. */
+    long long start;
+} MemorySeries;
+
+/**
+ * @brief The hardware performance counters of a measurement. A counter that can't be opened (no
+ * such event, or no permission, as in most containers) is left out rather than failing the run.
+ */
+typedef struct PerfCounters
+{
+    /** The file descriptor of every counter, or -1 if it isn't available. */
+    int descriptors[PERF_COUNTERS_COUNT];
+    /** The value of every counter, summed over the measurements and scaled for multiplexing. */
+    long long values[PERF_COUNTERS_COUNT];
+    /** The error of the first counter that failed to open, or 0. */
+    int error;
+} PerfCounters;
+
+/**
+ * @brief A traced span of time: something that began and ended on one thread.
+ */
+typedef struct TraceEvent
+{
+    /** The name of the event (a string literal). */
+    const char *name;
+    /** The time it began, in nanoseconds. */
+    long long begin;
+    /** The time it ended, in nanoseconds. */
+    long long end;
+    /** The index of the first sequence of the pair, or -1. */
+    int first;
+    /** The index of the second sequence of the pair, or -1. */
+    int second;
+} TraceEvent;
+
+/**
+ * @brief The ring buffer of the trace events of one thread. Only its thread writes it; when it is
+ * full the oldest events are overwritten.
+ */
+typedef struct __attribute__((aligned(CACHE_LINE_BYTES))) TraceBuffer
+{
+    /** The events, allocated on the first event of the thread. */
+    TraceEvent *events;
+    /** The number of events recorded, including the overwritten ones. */
+    long long count;
+} TraceBuffer;
+
+/**
+ * @brief The progress counters of one thread. Only their thread writes them, and the reporter
+ * reads them without a lock; each one has its own cache line so the threads don't share lines.
+ */
+typedef struct __attribute__((aligned(CACHE_LINE_BYTES))) ProgressCounter
+{
+    /** The number of pairs whose score is known. */
+    long long pairs;
+    /** The cells (length1 * length2) of the pairs whose score is known. */
+    long long cells;
+    /** The cells the dynamic programming actually computed. */
+    long long computedCells;
+} ProgressCounter;
+
+/**
+ * @brief The state shared by all the comparisons of a run: the sequences, the weights, and the
+ * scores already computed for the distinct sequences.
+ */
+typedef struct ComparisonContext
+{
+    /** The sequences names array. */
+    char **sequencesNames;
+    /** The sequences array. */
+    char **sequences;
+    /** The number of sequences in the array. */
+    int numberOfSequences;
+    /** The weight of a match. */
+    int m;
+    /** The weight of a mismatch. */
+    int s;
+    /** The weight of a gap. */
+    int g;
+    /** The program options. */
+    const ProgramOptions *options;
+    /** The length of every sequence. */
+    int *lengths;
+    /** The 64 bit content hash of every sequence. */
+    uint64_t *hashes;
+    /** The index of the first sequence identical to every sequence. */
+    int *representatives;
+    /** The scores of the pairs of representatives computed so far (numberOfSequences squared). */
+    int *scores;
+    /** Whether the score of every pair of representatives was computed. */
+    char *scoreKnown;
+    /** The persistent pair scores cache, or NULL if there is none. */
+    ScoreCache *cache;
+    /** The scores of every pair of sequences compared in this run (numberOfSequences squared). */
+    int *pairScores;
+    /** Whether every pair of sequences was compared in this run. */
+    char *pairCompared;
+    /** The results of a previous run, or NULL if there are none. */
+    PreviousResults *previous;
+    /** The index of every sequence in the previous run, or -1 for a new sequence. */
+    int *previousIndices;
+    /** The number of pairs whose score was taken from the previous run. */
+    int reusedPairs;
+    /** The code of every residue, for the profile kernels. */
+    unsigned char residueCodes[ALPHABET_SIZE];
+    /** The number of residue codes. */
+    int alphabetSize;
+    /** The engine chosen for every bucket of pair sizes (with --auto). */
+    int planEngines[AUTO_BUCKETS];
+    /** Guards the scores, the cache, the counters and the reserved memory between threads. */
+    pthread_mutex_t lock;
+    /** Signaled when memory reserved by a pair is released. */
+    pthread_cond_t memoryReleased;
+    /** The bytes reserved by the pairs being aligned. */
+    size_t reservedMemory;
+    /** The number of pairs holding reserved memory. */
+    int activePairs;
+    /** The number of pairs aligned with every strategy (with --mem-limit). */
+    int strategyCounts[STRATEGIES_COUNT];
+    /** The index (in print order) of the first pair of the shard of the run. */
+    long long shardFirstPair;
+    /** The index (in print order) after the last pair of the shard of the run. */
+    long long shardEndPair;
+    /** The journal of a checkpointed run, or NULL. */
+    FILE *journal;
+    /** The time of the last checkpoint, in nanoseconds. */
+    long long lastCheckpointTime;
+    /** Whether a scoring pass journaled the scores of its pairs, so the printing doesn't. */
+    int pairsJournaled;
+    /** The progress counters of the main thread and of every worker thread, or NULL. */
+    ProgressCounter *progress;
+    /** Whether the pairs are counted as done when printed (else a scoring pass counts them). */
+    int progressOnPrint;
+    /** The number of pairs of the run. */
+    long long progressTotalPairs;
+    /** The cells of the pairs of the run. */
+    long long progressTotalCells;
+    /** The time the progress started, in nanoseconds. */
+    long long progressStart;
+    /** The time of the last report, in nanoseconds. */
+    long long progressLastTime;
+    /** The computed cells at the last report. */
+    long long progressLastCells;
+    /** The thread reporting the progress. */
+    pthread_t progressThread;
+    /** Whether the reporter has to stop (guarded by the context lock). */
+    int progressStopped;
+    /** Signaled to stop the reporter. */
+    pthread_cond_t progressStop;
+    /** The statistics of every pair (by the pair key), or NULL without --stats. */
+    PairStatistics *pairStatistics;
+    /** The nanoseconds spent in every phase (PHASE_*), measured with --stats. */
+    long long phaseTimes[PHASES_COUNT];
+} ComparisonContext;
+
+/**
+ * @brief A pair of sequences requested by a pair-list file, scheduled with the pairs that share
+ * its query sequence.
+ */
+typedef struct RequestedPair
+{
+    /** The index of the query sequence (the smaller index of the pair). */
+    int query;
+    /** The index of the target sequence (the larger index of the pair). */
+    int target;
+    /** The index of the sequence named first in the file. */
+    int first;
+    /** The index of the sequence named second in the file. */
+    int second;
+    /** The line of the pair in the file, counting only the pairs. */
+    int request;
+} RequestedPair;
+
+/**
+ * @brief The pairs shared by the threads that score them in parallel.
+ */
+typedef struct ParallelScoring
+{
+    /** The comparison context. */
+    ComparisonContext *context;
+    /** The pairs to score, as (first, second) index pairs. */
+    int (*pairs)[2];
+    /** The number of pairs. */
+    int pairsCount;
+    /** The next pair to take (guarded by the context lock). */
+    int nextPair;
+    /** The number of threads started (guarded by the context lock). */
+    int threadsStarted;
+} ParallelScoring;
+
+/**
+ * @brief A block of queries scored against the database by several threads.
+ */
+typedef struct DatabaseScoring
+{
+    /** The profiles of the queries (those of the block are built). */
+    const QueryProfile *profiles;
+    /** The first query of the block. */
+    int firstQuery;
+    /** The query after the last one of the block. */
+    int lastQuery;
+    /** The database sequences. */
+    char **database;
+    /** The lengths of the database sequences. */
+    const int *databaseLengths;
+    /** The number of database sequences. */
+    int databaseCount;
+    /** The code of every residue. */
+    const unsigned char *residueCodes;
+    /** The weight of a gap. */
+    int g;
+    /** The length of the longest query, which the rows of a thread are sized for. */
+    int maximalQueryLength;
+    /** The scores of the queries against the database, query by query. */
+    int *blockScores;
+    /** The next database sequence to take (taken atomically). */
+    int nextTarget;
+    /** Whether a thread failed to allocate its rows (set atomically). */
+    int failed;
+} DatabaseScoring;
+
+/**
+ * @brief The tiles of the pairs shared by the threads that score them in cache friendly order. A
+ * tile is a block of queries compared to the targets of a panel.
+ */
+typedef struct TiledScoring
+{
+    /** The comparison context. */
+    ComparisonContext *context;
+    /** The shared minimizers counts, or NULL if there is no prefilter. */
+    const int *sharedSeeds;
+    /** The sequences, sorted by length. */
+    const SequenceLength *order;
+    /** The index in the order of the first sequence of every block, and the sequences count. */
+    const int *blockStarts;
+    /** The tiles, as (block, first block of the panel, block after the panel) triples. */
+    int (*tiles)[3];
+    /** The number of tiles. */
+    int tilesCount;
+    /** The next tile to take (guarded by the context lock). */
+    int nextTile;
+    /** The number of threads started (guarded by the context lock). */
+    int threadsStarted;
+    /** Whether the tiles are scored by worker threads, rather than by the main thread. */
+    int workerThreads;
+    /** The code of every residue. */
+    const unsigned char *residueCodes;
+    /** The number of residue codes. */
+    int alphabetSize;
+    /** The length of the longest sequence, which the rows of a thread are sized for. */
+    int maximalLength;
+    /** The name of the profile kernel, for the statistics. */
+    const char *kernelName;
+    /** Whether a thread failed to allocate its workspace (set atomically). */
+    int failed;
+} TiledScoring;
+
+/**
+ * @brief The alignment of a growing first sequence to a fixed second sequence. Only the last row
+ * of the dynamic programming table is kept, so appending residues to the first sequence computes
+ * only the new rows.
+ */
+typedef struct ExtensibleAlignment
+{
+    /** The second sequence (not owned by the alignment). */
+    const char *sequence2;
+    /** The length of the second sequence. */
+    int length2;
+    /** The weight of a match. */
+    int m;
+    /** The weight of a mismatch. */
+    int s;
+    /** The weight of a gap. */
+    int g;
+    /** The number of residues of the first sequence aligned so far. */
+    int length1;
+    /** The last row of the table (length2 + 1 cells). */
+    int *row;
+} ExtensibleAlignment;
+
+/**
+ * @brief A client of the score server, and the request being read from it.
+ */
+typedef struct ServerConnection
+{
+    /** The socket, or -1 if the slot is free. */
+    int socket;
+    /** The length prefix of the request, as read so far. */
+    unsigned char prefix[SERVE_PREFIX_BYTES];
+    /** The number of bytes of the length prefix read. */
+    int prefixBytes;
+    /** The residues of the query. */
+    char *query;
+    /** The number of residues allocated for the query. */
+    int queryCapacity;
+    /** The length of the query, from its prefix. */
+    int queryLength;
+    /** The number of residues of the query read. */
+    int queryBytes;
+    /** Whether a worker is answering the query (guarded by the server lock). */
+    int busy;
+    /** The response to the last query: the status and the scores, in network byte order. */
+    uint32_t *response;
+    /** The bytes left to send to the client (the greeting or the response), sent by the main
+     * thread as the socket takes them. */
+    const unsigned char *output;
+    /** The number of bytes of the output. */
+    size_t outputBytes;
+    /** The number of bytes of the output sent. */
+    size_t outputSent;
+} ServerConnection;
+
+/**
+ * @brief The score server: the database, loaded once, the clients, and the queue of the queries
+ * read in full, which the workers answer.
+ */
+typedef struct ScoreServer
+{
+    /** The database sequences. */
+    SequenceSpan database[MAXIMAL_NUMBER_OF_SEQUENCES];
+    /** The number of database sequences. */
+    int databaseCount;
+    /** The names and lengths of the database sequences, as sent to every new client. */
+    unsigned char *greeting;
+    /** The number of bytes of the greeting. */
+    size_t greetingBytes;
+    /** The clients. */
+    ServerConnection connections[SERVE_MAXIMAL_CONNECTIONS];
+    /** The clients whose query is read in full, in the order they were read (a ring). */
+    int queue[SERVE_MAXIMAL_CONNECTIONS];
+    /** The first client in the queue. */
+    int queueHead;
+    /** The number of clients in the queue. */
+    int queueCount;
+    /** Whether the workers stop. */
+    int stopping;
+    /** The number of workers started. */
+    int threadsStarted;
+    /** The pipe a worker writes to when it answers, so the main thread sends the response. */
+    int wakePipe[2];
+    /** The lock of the queue and of the busy flags. */
+    pthread_mutex_t lock;
+    /** Signaled when a query is queued, or the workers stop. */
+    pthread_cond_t queued;
+} ScoreServer;
+
+/**
+ * @brief A worker of the score server, with an aligner and buffers kept warm between queries.
+ */
+typedef struct ServerWorker
+{
+    /** The server. */
+    ScoreServer *server;
+    /** The aligner, with a workspace for the longest database sequence. */
+    SequencesAligner *aligner;
+    /** The pairs of a query with every database sequence. */
+    SequencePair *pairs;
+    /** The scores of the pairs. */
+    int *scores;
+    /** The thread. */
+    pthread_t thread;
+} ServerWorker;
+
+/**
+ * @brief An exact match between two sequences, used by the anchored alignment.
+ */
+typedef struct Anchor
+{
+    /** The start of the match in the first sequence. */
+    int position1;
+    /** The start of the match in the second sequence. */
+    int position2;
+    /** The length of the match. */
+    int length;
+} Anchor;
 
 // ------------------------------------------- functions ------------------------------------------
 /**
@@ -36,10 +851,42 @@ const char MEMORY_ALLOCATION_FAILED_MESSAGE[] = "Error - memory allocation faile
  * @param mAddress A pointer to the weight of a match.
  * @param sAddress A pointer to the weight of a mismatch.
  * @param gAddress A pointer to the weight of a gap.
+ * @param options A pointer to the options to fill.
  * @return 0 if the usage is valid, -1 else.
  */
 int checkUsage(int argc, char *argv[], char **fileNameAddress,
-               int *mAddress, int *sAddress, int *gAddress);
+               int *mAddress, int *sAddress, int *gAddress, ProgramOptions *options);
+/**
+ * @brief A function that reads the optional arguments of the program (the arguments starting with
+ * "--"), and collects the other arguments.
+ * @param argc The number of program arguments.
+ * @param argv The program arguments.
+ * @param options A pointer to the options to fill (they are first set to their defaults).
+ * @param arguments The array to collect the program name and the mandatory arguments to (of
+ * NUMBER_OF_ARGUMENTS cells).
+ * @param argumentsCountAddress A pointer to the number of arguments collected.
+ * @return 0 if the options are valid and can be combined, -1 else.
+ */
+int checkOptions(int argc, char *argv[], ProgramOptions *options, char *arguments[],
+                 int *argumentsCountAddress);
+/**
+ * @brief A function that reads the value of an option that expects a string (a file name).
+ * @param argc The number of program arguments.
+ * @param argv The program arguments.
+ * @param indexAddress A pointer to the index of the option (advanced to the index of its value).
+ * @param valueAddress A pointer to the value to read.
+ * @return 0 if the value exists, -1 else.
+ */
+int checkStringOptionValue(int argc, char *argv[], int *indexAddress, char **valueAddress);
+/**
+ * @brief A function that reads the value of an option that expects a positive integer.
+ * @param argc The number of program arguments.
+ * @param argv The program arguments.
+ * @param indexAddress A pointer to the index of the option (advanced to the index of its value).
+ * @param valueAddress A pointer to the value to read.
+ * @return 0 if the value exists and is a positive integer, -1 else.
+ */
+int checkPositiveOptionValue(int argc, char *argv[], int *indexAddress, int *valueAddress);
 /**
  * @brief A function that checks valid integer input, and reads it.
  * @param str A string (should represents an integer).
@@ -75,344 +922,6633 @@ int deleteNewline(char *row);
  * @param g The weight of a gap.
  */
 void compareSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
-                      int m, int s, int g);
+                      int m, int s, int g, const ProgramOptions *options);
 /**
- * @brief A function that compares two sequences using a dynamic programming algorithm, and prints
- * their score and match.
+ * @brief A function that prepares the comparison context of a run: measures and hashes the
+ * sequences, and groups the identical ones under their first occurrence.
+ * @param context The context to fill.
  * @param sequencesNames The sequences names array.
  * @param sequences The sequences array.
  * @param numberOfSequences The number of sequences in the array.
- * @param sequence1Name The first sequence's name.
- * @param sequences2Name The second sequence's name.
- * @param sequence1 The first sequence to compare.
- * @param sequence2 The second sequence to compare.
  * @param m The weight of a match.
  * @param s The weight of a mismatch.
  * @param g The weight of a gap.
+ * @param options The program options.
  */
-void compareTwoSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
-                         char *sequence1Name, char *sequences2Name,
-                         char *sequence1, char *sequence2, int m, int s, int g);
+void initializeComparisonContext(ComparisonContext *context, char *sequencesNames[],
+                                 char *sequences[], int numberOfSequences, int m, int s, int g,
+                                 const ProgramOptions *options);
 /**
- * @brief A function that frees the memory allocated for the sequences array.
- * @param sequences The sequences array.
- * @param numberOfSequences The number of sequences in the array.
+ * @brief A function that frees the memory allocated for a comparison context.
+ * @param context The context.
  */
-void freeSequencesMemory(char *sequences[], int numberOfSequences);
+void freeComparisonContext(ComparisonContext *context);
 /**
- * @brief A function that allocates memory for the table used in the dynamic algorithm to compare
- * two sequences (if the allocation failed, the function frees the memory aready allocated by the
- * program).
- * @param sequencesNames The sequences names array.
- * @param sequences The sequences array.
- * @param numberOfSequences The number of sequences in the array.
- * @param tableAddress A pointer to the table.
- * @param tableRows The number of rows in the table.
- * @param tableColumns The number of columns in the table.
+ * @brief A function that hashes the content of a sequence into 64 bits (in the style of xxhash:
+ * 8 bytes at a time, each one multiplied, rotated and folded into the accumulator).
+ * @param sequence The sequence.
+ * @param length The length of the sequence.
+ * @return The hash of the sequence.
  */
-void allocateTable(char *sequencesNames[], char *sequences[], int numberOfSequences,
-                   int ***tableAddress, int tableRows, int tableColumns);
+uint64_t hashSequence(const char *sequence, int length);
 /**
- * @brief A function that fills the table used in the dynamic algorithm to compare two sequences.
- * @param sequence1 The first sequence compared.
- * @param sequence2 The second sequence compared.
- * @param table The (empty) table.
- * @param tableRows The number of rows in the table.
- * @param tableColumns The number of columns in the table.
- * @param m The weight of a match.
- * @param s The weight of a mismatch.
- * @param g The weight of a gap.
+ * @brief A function that rotates the bits of a 64 bit value to the left.
+ * @param value The value.
+ * @param bits The number of bits to rotate by (between 1 and 63).
+ * @return The rotated value.
  */
-void fillTable(char *sequence1, char *sequence2, int **table,
-               int tableRows, int tableColumns, int m, int s, int g);
+uint64_t rotateLeft(uint64_t value, int bits);
 /**
- * brief A function that initializes the table used in the dynamic algorithm to compare two
- * sequences.
- * @param table The (empty) talbe.
- * @param tableRows The number of rows in the table.
- * @param tableColumns The number of columns in the table.
- * @param g The weight of a gap.
+ * @brief A function that returns the score of a pair of sequences, aligning them only if the same
+ * pair of distinct sequences wasn't aligned before, and their score isn't trivial.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @return The score of the alignment of the two sequences.
  */
-void initializeTable(int **table, int tableRows, int tableColumns, int g);
+int scorePair(ComparisonContext *context, int first, int second);
 /**
- * @brief A function that fills a cell in the table used in the dynamic algorithm to compare two
- * sequences.
- * @param sequence1 The first sequence compared.
- * @param sequence2 The second sequence compared.
- * @param table The table.
- * @param row The number of row of the cell.
- * @param column The number of column of the cell.
- * @param m The weight of a match.
- * @param s The weight of a mismatch.
- * @param g The weight of a gap.
+ * @brief A function that looks for the score of a pair of sequences without aligning them: in the
+ * previous results, by the identity of the sequences, among the scores computed in this run, and
+ * in the persistent cache.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param scoreAddress A pointer to the score, set if it is found.
+ * @return 1 if the score was found, 0 if the pair has to be aligned.
  */
-void fillTableCell(char *sequence1, char *sequence2, int **table,
-                   int row, int column, int m, int s, int g);
+int findPairScore(ComparisonContext *context, int first, int second, int *scoreAddress);
 /**
- * @brief A function that computes the first opportunity for a cell in the table used in the
- * dynamic algorithm to compare two sequences (according to the exercise PDF).
- * @param sequence1 The first sequence compared.
- * @param sequence2 The second sequence compared.
- * @param table The table.
- * @param row The number of row of the cell.
- * @param column The number of column of the cell.
- * @param m The weight of a match.
- * @param s The weight of a mismatch.
- * @return  The first opportunity for a cell in the table used in the dynamic algorithm to compare
- * two sequences (according to the exercise PDF).
+ * @brief A function that checks whether the score of a pair is known from the previous run.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @return 1 if the previous run scored the pair, 0 else.
  */
-int computeFirstMatchScore(char *sequence1, char *sequence2, int **table,
-                           int row, int column, int m, int s);
+int isReusedPair(const ComparisonContext *context, int first, int second);
 /**
- * @brief A function that computes the second opportunity for a cell in the table used in the
- * dynamic algorithm to compare two sequences (according to the exercise PDF).
- * @param table The table.
- * @param row The number of row of the cell.
- * @param column The number of column of the cell.
- * @param g The weight of a gap.
- * @return The second opportunity for a cell in the table used in the dynamic algorithm to compare
- * two sequences (according to the exercise PDF).
+ * @brief A function that records the score of an aligned pair of sequences, in the scores of this
+ * run and in the persistent cache.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param score The score of the pair.
  */
-int computeSecondMatchScore(int **table, int row, int column, int g);
+void storePairScore(ComparisonContext *context, int first, int second, int score);
 /**
- * @brief A function that computes the third opportunity for a cell in the table used in the
- * dynamic algorithm to compare two sequences (according to the exercise PDF).
- * @param table The table.
- * @param row The number of row of the cell.
- * @param column The number of column of the cell.
- * @param g The weight of a gap.
- * @return The third opportunity for a cell in the table used in the dynamic algorithm to compare
- * two sequences (according to the exercise PDF).
+ * @brief A function that checks whether a pair passes the prefilter.
+ * @param sharedSeeds The shared minimizers counts, or NULL if there is no prefilter.
+ * @param numberOfSequences The number of sequences.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param minimalSharedSeeds The minimal number of shared minimizers of a candidate pair.
+ * @return 1 if the pair has to be compared, 0 else.
  */
-int computeThirdMatchScore(int **table, int row, int column, int g);
+int isCandidatePair(const int *sharedSeeds, int numberOfSequences, int first, int second,
+                    int minimalSharedSeeds);
 /**
- * @brief A function that computes the maximum of three integers.
- * @param n1 The first integer.
- * @param n2 The second integer.
- * @param n3 The third integer.
- * @return The maximum of the three integers.
+ * @brief A function that computes the scores of all the pairs that need an alignment in cache
+ * friendly order, before they are printed in the usual order. The sequences are sorted by length
+ * and split into blocks whose residues, profiles and rows fit in the L2 cache, grouped into panels
+ * that fit in the L3 cache. For every panel of targets, every block of queries builds its
+ * profiles once and is compared to the targets of the panel. These tiles are independent, and are
+ * shared by the --threads threads.
+ * @param context The comparison context.
+ * @param sharedSeeds The shared minimizers counts, or NULL if there is no prefilter.
  */
-int max3(int n1, int n2, int n3);
+void scorePairsTiled(ComparisonContext *context, const int *sharedSeeds);
 /**
- * @brief A function that computes the maximum of two numbers.
- * @param n1 The first number.
- * @param n2 The second number.
- * @return The maximum of the two numbers.
+ * @brief A function that scores the tiles it takes until there are none left. It is the main
+ * function of the threads of scorePairsTiled, and is called by the main thread on a single thread.
+ * @param argument The tiled scoring, shared by the threads (a TiledScoring pointer).
+ * @return NULL.
  */
-int max(int n1, int n2);
+void *scoreTilesWorker(void *argument);
 /**
- * @brief A function that prints the score of the comparison of two sequences.
- * @param table The table used in the dynamic algorithm to compare two sequences.
- * @param tableRows The number of rows in the table.
- * @param tableColumns The number of columns in the table.
- * @param sequence1Name The name of the first sequence in the sequences array.
- * @param sequence2Name The name of the second sequence in the sequences array.
+ * @brief A function that scores the pairs of a tile: it builds the profiles of the block of
+ * queries and compares them to the targets of the panel.
+ * @param scoring The tiled scoring.
+ * @param tile The index of the tile.
+ * @param profiles The profiles of the thread, indexed like the sorted sequences.
+ * @param row A buffer of two rows for the profile kernel.
+ * @return 0 on success, -1 if a profile allocation failed.
  */
-void printScore(int **table, int tableRows, int tableColumns,
-                char *sequence1Name, char *sequence2Name);
+int scoreTile(TiledScoring *scoring, int tile, QueryProfile *profiles, int *row);
 /**
- * @brief A function that frees the memory allocated for the table used in the dynamic algorithm to
- * compare two sequences.
- * @param table The table.
- * @param tableRows The number of rows in the table.
+ * @brief A function that checks whether a pair is compared by the run: it is in the shard of the
+ * run and passes the prefilter.
+ * @param context The comparison context.
+ * @param sharedSeeds The shared minimizers counts, or NULL if there is no prefilter.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence (larger than the first).
+ * @return 1 if the pair has to be compared, 0 else.
  */
-void freeTableMemory(int **table, int tableRows);
+int isScheduledPair(const ComparisonContext *context, const int *sharedSeeds, int first,
+                    int second);
+/**
+ * @brief A function that returns the index of a pair in the order the pairs are printed in.
+ * @param numberOfSequences The number of sequences.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence (larger than the first).
+ * @return The index of the pair.
+ */
+long long getPairIndex(int numberOfSequences, int first, int second);
+/**
+ * @brief A function that finds the pairs of the shard of the run. The pairs are split, in print
+ * order, into contiguous ranges of about the same cost (the cells of every pair, plus one so that
+ * empty sequences count too), so every shard finds the same ranges from the same input.
+ * @param context The comparison context (its shard range is set).
+ */
+void findShardRange(ComparisonContext *context);
+/**
+ * @brief A function that hashes the names and the contents of the sequences of the run, to tell
+ * the partial results of other inputs apart.
+ * @param context The comparison context.
+ * @return The hash of the input.
+ */
+uint64_t hashInput(const ComparisonContext *context);
+/**
+ * @brief A function that merges the partial results files of all the shards of a run, and prints
+ * the output of the whole run (the "merge" subcommand). The files are checked to be complete and
+ * to come from the same input and weights before anything is printed.
+ * @param filesCount The number of partial results files.
+ * @param fileNames The paths of the partial results files.
+ * @return 0 on success, -1 if the files are missing, incomplete or inconsistent.
+ */
+int mergeShards(int filesCount, char *fileNames[]);
+/**
+ * @brief A function that reads the header of a partial results file, and checks that the file ends
+ * with the end marker (written after the last score, so a shard killed midway has none).
+ * @param file The partial results file.
+ * @param header The header fields to fill (shard index, shards count, m, s, g, input hash, first
+ * pair, end pair, number of pairs, scoring mode).
+ * @return 0 if the file is a complete partial results file, -1 else.
+ */
+int readShardHeader(FILE *file, long long header[SHARD_HEADER_FIELDS - 1]);
+/**
+ * @brief A function that starts a checkpointed run: the standard output is redirected to the
+ * output file, and the journal is created, or (with --resume) read back. A resumed output file is
+ * cut back to the size it had at the last complete checkpoint, and the run continues from the
+ * pair after it. The journaled scores are loaded back, and the pairs printed before the
+ * checkpoint count as compared.
+ * @param context The comparison context.
+ * @param resumePairAddress A pointer to the index of the first pair left to compare (set to -1 if
+ * no pair was journaled).
+ * @param printedPairsAddress A pointer to the number of pairs printed before it.
+ * @return 0 on success, 1 if the journaled run is already finished, -1 if the files couldn't be
+ * opened or the journal belongs to another run.
+ */
+int openCheckpoint(ComparisonContext *context, long long *resumePairAddress,
+                   long long *printedPairsAddress);
+/**
+ * @brief A function that makes the output printed so far durable, and journals it: the output is
+ * flushed and synced, and then a record of the next pair, the size of the output and the number of
+ * pairs printed is appended to the journal and synced.
+ * @param context The comparison context.
+ * @param nextPair The index of the first pair not printed yet.
+ * @param printedPairs The number of pairs printed.
+ */
+void writeCheckpoint(ComparisonContext *context, long long nextPair, long long printedPairs);
+/**
+ * @brief A function that journals the score of a pair of a checkpointed run, so a resumed run
+ * neither scores it again nor leaves it out of the matrix and the statistics. The scoring passes,
+ * which print nothing, also sync the journal once the checkpoint interval elapsed.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param score The score of the pair.
+ * @param sync Whether to sync the journal if the checkpoint interval elapsed.
+ */
+void journalPairScore(ComparisonContext *context, int first, int second, int score, int sync);
+/**
+ * @brief A function that journals the end of a checkpointed run, and closes the journal.
+ * @param context The comparison context.
+ */
+void closeCheckpoint(ComparisonContext *context);
+/**
+ * @brief A function that gives a dense code to every residue of a sequence that has none yet.
+ * @param sequence The sequence.
+ * @param length The length of the sequence.
+ * @param residueCodes The code of every residue.
+ * @param seen Whether every residue has a code.
+ * @param alphabetSize The number of codes given so far.
+ * @return The number of codes given, including the new ones.
+ */
+int addToAlphabet(const char *sequence, int length, unsigned char *residueCodes, char *seen,
+                  int alphabetSize);
+/**
+ * @brief A comparison function of sequence lengths for qsort, by length and then by index.
+ * @param first A pointer to the first sequence length.
+ * @param second A pointer to the second sequence length.
+ * @return A negative number, zero or a positive number if the first sequence is shorter, as long
+ * or longer than the second one.
+ */
+int compareSequenceLengths(const void *first, const void *second);
+/**
+ * @brief A function that returns the scoring mode of the run, which tells scores computed with
+ * different algorithms apart.
+ * @param options The program options.
+ * @return 0 for the exact score, the k-mer length for the anchored score.
+ */
+int getScoringMode(const ProgramOptions *options);
+/**
+ * @brief A function that reads the scores matrix of a previous run, and matches every sequence of
+ * this run to the previous sequence with the same name and content.
+ * @param context The comparison context.
+ * @param fileName The path of the previous scores matrix.
+ * @return 0 on success, -1 if the file couldn't be read, is malformed, or was computed with other
+ * weights or another scoring mode.
+ */
+int loadPreviousResults(ComparisonContext *context, const char *fileName);
+/**
+ * @brief A function that frees the memory allocated for the results of a previous run.
+ * @param previous The previous results (may be NULL).
+ */
+void freePreviousResults(PreviousResults *previous);
+/**
+ * @brief A function that splits a line into tab separated fields, in place (the line break at its
+ * end is removed).
+ * @param line The line.
+ * @param fields The array to write the fields to.
+ * @param maximalFields The size of the fields array.
+ * @return The number of fields, or -1 if there are more than maximalFields.
+ */
+int splitTabs(char *line, char **fields, int maximalFields);
+/**
+ * @brief A function that writes the scores of the run as a TSV matrix: a signature line with the
+ * weights and the scoring mode, a line of content hashes, a line of names, and a row per sequence.
+ * The cell of row i and column j is the score of i aligned to j. The anchored scores aren't
+ * symmetric, so under --anchored only the direction that was computed is written (the other one
+ * is missing).
+ * @param context The comparison context.
+ * @param fileName The path of the matrix file.
+ * @return 0 on success, -1 if a name contains a tab (which would break the TSV) or the file
+ * couldn't be written.
+ */
+int writeResultsMatrix(const ComparisonContext *context, const char *fileName);
+/**
+ * @brief A function that opens (or creates) a persistent pair scores cache file and maps it.
+ * @param fileName The path of the cache file.
+ * @param capacity The number of entries of the file, if it is created.
+ * @return The cache, or NULL if the file couldn't be opened, created or mapped.
+ */
+ScoreCache *openScoreCache(const char *fileName, int capacity);
+/**
+ * @brief A function that unmaps and closes a persistent pair scores cache.
+ * @param cache The cache (may be NULL).
+ */
+void closeScoreCache(ScoreCache *cache);
+/**
+ * @brief A function that locks or unlocks the whole cache file for the other processes.
+ * @param cache The cache.
+ * @param lockType F_RDLCK for a shared lock, F_WRLCK for an exclusive lock, F_UNLCK to unlock.
+ */
+void lockScoreCache(ScoreCache *cache, short lockType);
+/**
+ * @brief A function that fills the key fields of a cache entry for a pair of sequences.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param key The entry to fill.
+ */
+void makeScoreCacheKey(const ComparisonContext *context, int first, int second,
+                       ScoreCacheEntry *key);
+/**
+ * @brief A function that checks whether a cache entry holds the score of a key.
+ * @param entry The cache entry.
+ * @param key The key.
+ * @return 1 if the entry matches the key, 0 else.
+ */
+int matchScoreCacheEntry(const ScoreCacheEntry *entry, const ScoreCacheEntry *key);
+/**
+ * @brief A function that returns the first slot of the probe sequence of a key.
+ * @param cache The cache.
+ * @param key The key.
+ * @return The index of the first slot.
+ */
+uint32_t getScoreCacheSlot(const ScoreCache *cache, const ScoreCacheEntry *key);
+/**
+ * @brief A function that looks up the score of a pair in the cache.
+ * @param cache The cache.
+ * @param key The key of the pair.
+ * @param scoreAddress A pointer to the score, set on a hit.
+ * @return 1 on a hit, 0 on a miss.
+ */
+int lookupScoreCache(ScoreCache *cache, const ScoreCacheEntry *key, int *scoreAddress);
+/**
+ * @brief A function that stores the score of a pair in the cache. If the probe window of the key
+ * is full, the least recently used entry of the window is replaced.
+ * @param cache The cache.
+ * @param key The key of the pair.
+ * @param score The score of the pair.
+ */
+void storeScoreCache(ScoreCache *cache, const ScoreCacheEntry *key, int score);
+/**
+ * @brief A function that chooses the engine of every bucket of pair sizes: it loads the plan file
+ * if it is valid, and otherwise times every engine on a sample of the pairs of each bucket (within
+ * a time budget per bucket, projected before every sample), keeps the fastest, and saves the plan
+ * file. The scores of the samples are stored in the context.
+ * @param context The comparison context.
+ */
+void planEngines(ComparisonContext *context);
+/**
+ * @brief A function that takes the first pairs of every bucket of pair sizes as its samples.
+ * @param context The comparison context.
+ * @param samples The samples of every bucket, as pairs of indices.
+ * @param samplesCount The number of samples of every bucket.
+ */
+void collectBucketSamples(const ComparisonContext *context,
+                          int samples[AUTO_BUCKETS][AUTO_SAMPLES_PER_BUCKET][2],
+                          int samplesCount[AUTO_BUCKETS]);
+/**
+ * @brief A function that benchmarks every engine on the sampled pairs of every bucket of pair
+ * sizes (repeated for at least BENCH_MINIMAL_NANOSECONDS), and prints the time, cycles and
+ * instructions per cell, and the cache and branch misses per thousand cells of each.
+ * @param sequencesNames The names of the sequences.
+ * @param sequences The sequences.
+ * @param numberOfSequences The number of sequences.
+ * @param m The match weight.
+ * @param s The mismatch weight.
+ * @param g The gap weight.
+ * @param options The program options.
+ */
+void benchmarkEngines(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g, const ProgramOptions *options);
+/**
+ * @brief A function that opens the hardware performance counters, disabled.
+ * @param counters The counters.
+ * @param inherit Whether to also count the threads created after they are opened.
+ * @return The number of counters opened.
+ */
+int openPerfCounters(PerfCounters *counters, int inherit);
+/**
+ * @brief A function that resets and enables the opened counters.
+ * @param counters The counters.
+ */
+void startPerfCounters(PerfCounters *counters);
+/**
+ * @brief A function that disables the opened counters, and adds their values.
+ * @param counters The counters.
+ */
+void stopPerfCounters(PerfCounters *counters);
+/**
+ * @brief A function that closes the opened counters.
+ * @param counters The counters.
+ */
+void closePerfCounters(PerfCounters *counters);
+/**
+ * @brief A function that writes the counters per cell: cycles per cell, instructions per cycle,
+ * and the L1d, LLC and branch misses per thousand cells ("n/a" for a counter not available).
+ * @param file The file.
+ * @param counters The counters.
+ * @param cells The number of cells measured.
+ */
+void printPerfCounters(FILE *file, const PerfCounters *counters, long long cells);
+/**
+ * @brief A function that returns the bucket of a pair by its number of cells: the first bucket
+ * holds pairs of less than AUTO_FIRST_BUCKET_CELLS cells, and every next bucket is
+ * AUTO_BUCKET_FACTOR times larger (the last bucket holds the rest).
+ * @param cells The number of cells of the pair.
+ * @return The bucket of the pair.
+ */
+int getPairBucket(long long cells);
+/**
+ * @brief A function that returns the number of engines (the table, the rolling row, and a profile
+ * engine per variant of the profile kernel).
+ * @return The number of engines.
+ */
+int getEnginesCount(void);
+/**
+ * @brief A function that returns the name of an engine, as written in plan files.
+ * @param engine The engine.
+ * @param name The buffer to write the name to (of MAXIMAL_ENGINE_NAME_LENGTH characters).
+ */
+void getEngineName(int engine, char *name);
+/**
+ * @brief A function that scores two sequences with an engine.
+ * @param context The comparison context.
+ * @param engine The engine.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @return The score of the alignment of the two sequences.
+ */
+int scoreWithEngine(ComparisonContext *context, int engine, int first, int second);
+/**
+ * @brief A function that loads an engines plan file.
+ * @param context The comparison context.
+ * @param fileName The path of the plan file.
+ * @return 0 if the plan was loaded, -1 if the file is missing, malformed, names an engine this
+ * CPU can't run, or was calibrated for another widest engine, other weights or another input.
+ */
+int loadEnginesPlan(ComparisonContext *context, const char *fileName);
+/**
+ * @brief A function that saves the engines plan to a file: a header of the widest engine the CPU
+ * runs, the weights and the input hash, and the engine of every bucket.
+ * @param context The comparison context.
+ * @param fileName The path of the plan file.
+ * @return 0 on success, -1 if the file couldn't be written.
+ */
+int saveEnginesPlan(const ComparisonContext *context, const char *fileName);
+/**
+ * @brief A function that aligns two sequences with the algorithm chosen by the program options.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @return The score of the alignment of the two sequences.
+ */
+int alignPair(ComparisonContext *context, int first, int second);
+/**
+ * @brief A function that compares every query sequence to every database sequence (the Q x D
+ * rectangle), and prints the scores query by query. The queries are processed in blocks whose
+ * profiles fit in the L2 cache, and the whole database streams past each block, its sequences
+ * shared by the --threads threads.
+ * @param queryNames The query names array.
+ * @param queries The query sequences array.
+ * @param queriesCount The number of queries.
+ * @param databaseNames The database names array.
+ * @param database The database sequences array.
+ * @param databaseCount The number of database sequences.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param options The program options.
+ */
+void compareQueriesToDatabase(char *queryNames[], char *queries[], int queriesCount,
+                              char *databaseNames[], char *database[], int databaseCount,
+                              int m, int s, int g, const ProgramOptions *options);
+/**
+ * @brief A function that scores the queries of a block against the database sequences it takes,
+ * until there are none left. It is the main function of the threads of compareQueriesToDatabase,
+ * and is called by the main thread too.
+ * @param argument The block scoring, shared by the threads (a DatabaseScoring pointer).
+ * @return NULL.
+ */
+void *scoreDatabaseWorker(void *argument);
+/**
+ * @brief A function that chooses the variant of the profile kernel: the one forced by --isa or by
+ * the COMPARE_SEQUENCES_ISA environment variable, or else the widest one the CPU supports up to
+ * DEFAULT_WIDEST_ISA. The wider AVX-512 kernel measures slower than the AVX2 one (the row scan is
+ * scalar, and the wide units lower the clock), so it runs only when it is forced.
+ * @param isaName The instruction set forced by --isa, or NULL.
+ * @return 0 on success, -1 if the forced instruction set is unknown or unsupported by the CPU.
+ */
+int selectProfileKernel(const char *isaName);
+/**
+ * @brief A function that reads a weight triple written as m,s,g.
+ * @param str The string.
+ * @param triple The triple to fill.
+ * @return 0 if the triple is valid, -1 else.
+ */
+int checkWeightsTriple(const char *str, int triple[3]);
+/**
+ * @brief A function that compares each pair of sequences under every weight triple of the sweep,
+ * in a single pass over each pair, and prints the scores of every triple in the usual order.
+ * @param context The comparison context.
+ */
+void compareSequencesSweep(ComparisonContext *context);
+/**
+ * @brief A function that scores two sequences under up to SWEEP_LANES weight triples at once:
+ * every cell of the table holds one score per triple, and all of them are computed together.
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param weights The weights of a match, a mismatch and a gap, one per lane.
+ * @param row A buffer for the row (of length2 + 1 vectors).
+ * @param scores The vector to write the scores of the alignment to, one per lane.
+ */
+void scoreSweepLanes(const char *sequence1, int length1, const char *sequence2, int length2,
+                     const SweepVector weights[3], SweepVector *row, SweepVector *scores);
+/**
+ * @brief A function that replaces every lane of a vector by its maximum with another vector.
+ * @param target The vector to update.
+ * @param other The other vector.
+ */
+void maxSweepVector(SweepVector *target, const SweepVector *other);
+/**
+ * @brief A function that builds a minimizer index over the sequences, and counts for each pair of
+ * sequences the number of minimizers they share.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param options The program options (the k-mer and window lengths are taken from them).
+ * @param seedsCountAddress A pointer to the number of distinct minimizers indexed.
+ * @return A numberOfSequences x numberOfSequences matrix (in a single array) of shared minimizers
+ * counts, where a sequence that is too short to have minimizers shares -1 with every sequence.
+ */
+int *buildSeedIndex(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                    const ProgramOptions *options, int *seedsCountAddress);
+/**
+ * @brief A function that collects the (k, w) minimizers of a sequence (each minimizer position is
+ * collected once, even if it is the minimum of several windows).
+ * @param sequence The sequence.
+ * @param sequenceIndex The index of the sequence in the sequences array.
+ * @param kmerLength The length of the k-mers.
+ * @param windowLength The number of consecutive k-mers a minimizer is chosen from.
+ * @param kmerHashes A buffer for the k-mer hashes (at least as long as the sequence).
+ * @param seeds The array to write the minimizers to (at least as long as the sequence).
+ * @return The number of minimizers written.
+ */
+int collectMinimizers(const char *sequence, int sequenceIndex, int kmerLength, int windowLength,
+                      uint64_t *kmerHashes, Seed *seeds);
+/**
+ * @brief A function that hashes every k-mer of a sequence with a rolling hash.
+ * @param sequence The sequence.
+ * @param length The length of the sequence.
+ * @param kmerLength The length of the k-mers.
+ * @param kmerHashes The array to write the hashes to (at least as long as the sequence).
+ * @return The number of k-mers hashed (0 if the sequence is shorter than a k-mer).
+ */
+int hashKmers(const char *sequence, int length, int kmerLength, uint64_t *kmerHashes);
+/**
+ * @brief A function that scrambles the bits of a 64 bit value (the splitmix64 finalizer), so
+ * similar k-mers get unrelated hashes.
+ * @param value The value.
+ * @return The scrambled value.
+ */
+uint64_t mixHash(uint64_t value);
+/**
+ * @brief A comparison function of seeds for qsort, by hash and then by sequence index.
+ * @param first A pointer to the first seed.
+ * @param second A pointer to the second seed.
+ * @return A negative number, zero or a positive number if the first seed is smaller, equal or
+ * larger than the second one.
+ */
+int compareSeeds(const void *first, const void *second);
+/**
+ * @brief A function that returns the time of a monotonic clock in nanoseconds.
+ * @return The time in nanoseconds.
+ */
+long long getTimeNanoseconds(void);
+/**
+ * @brief A function that computes the score of the alignment of two sequences using a dynamic
+ * programming algorithm.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param sequence1 The first sequence to compare.
+ * @param sequence2 The second sequence to compare.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @return The score of the alignment.
+ */
+int scoreTwoSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      char *sequence1, char *sequence2, int m, int s, int g);
+/**
+ * @brief A function that computes the score of the global alignment of two sequences, keeping
+ * only one row of the dynamic programming table.
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param row A buffer for the row (of length2 + 1 cells).
+ * @return The score of the alignment.
+ */
+int scoreWithRollingRow(const char *sequence1, int length1, const char *sequence2, int length2,
+                        int m, int s, int g, int *row);
+/**
+ * @brief A function that advances a row of the dynamic programming table by some rows.
+ * @param row The row (of length2 + 1 cells), holding the row of the residues aligned so far.
+ * @param rowIndex The number of residues of the first sequence aligned so far.
+ * @param residues The next residues of the first sequence.
+ * @param count The number of residues.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ */
+void advanceRollingRow(int *row, int rowIndex, const char *residues, int count,
+                       const char *sequence2, int length2, int m, int s, int g);
+/**
+ * @brief A function that advances a row of the dynamic programming table by some rows, and records
+ * in the same pass the source of the best score of every new cell in 2 bits (DIRECTION_DIAGONAL,
+ * DIRECTION_UP, DIRECTION_LEFT, or DIRECTION_TIE when the diagonal and a gap are both best). The
+ * first column isn't stored, as its source is always up.
+ * @param row The row (of length2 + 1 cells), holding the row of the residues aligned so far.
+ * @param rowIndex The number of residues of the first sequence aligned so far.
+ * @param residues The next residues of the first sequence.
+ * @param count The number of residues.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param directions The directions of the new rows (count rows of getDirectionsRowBytes(length2)
+ * bytes).
+ */
+void fillDirections(int *row, int rowIndex, const char *residues, int count,
+                    const char *sequence2, int length2, int m, int s, int g,
+                    unsigned char *directions);
+/**
+ * @brief A function that returns the number of bytes of a row of a directions matrix.
+ * @param length2 The length of the second sequence.
+ * @return The number of bytes of a row.
+ */
+size_t getDirectionsRowBytes(int length2);
+/**
+ * @brief A function that follows the directions of some rows back from a cell, and appends the
+ * aligned residues (with GAP_CHAR in the gaps) in reverse order. Ties follow the diagonal. The
+ * trace stops on reaching the first row of the directions, or the first cell if it's row 0.
+ * @param sequence1 The first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param directions The directions of the rows after firstRow, filled by fillDirections.
+ * @param firstRow The row the directions start after.
+ * @param iAddress A pointer to the row of the cell to trace from (updated to where it stopped).
+ * @param jAddress A pointer to the column of the cell to trace from (updated to where it stopped).
+ * @param aligned1 The reversed aligned first sequence.
+ * @param aligned2 The reversed aligned second sequence.
+ * @param lengthAddress A pointer to the length of the reversed aligned sequences (updated).
+ */
+void traceDirections(const char *sequence1, const char *sequence2, int length2,
+                     const unsigned char *directions, int firstRow, int *iAddress, int *jAddress,
+                     char *aligned1, char *aligned2, int *lengthAddress);
+/**
+ * @brief A function that reverses two aligned sequences traced from their end, and terminates them.
+ * @param aligned1 The aligned first sequence.
+ * @param aligned2 The aligned second sequence.
+ * @param length The length of the aligned sequences.
+ */
+void reverseAlignment(char *aligned1, char *aligned2, int length);
+/**
+ * @brief A function that traces an alignment too large for its directions to fit the traceback
+ * memory budget. The forward pass writes a checkpoint row every segment of rows whose directions
+ * fit the budget to a scratch file, in large sequential blocks; the traceback then reads them back
+ * a block at a time, and recomputes the directions of the segments from their checkpoints, last
+ * segment first.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param aligned1 The buffer of the aligned first sequence (length1 + length2 + 1 characters).
+ * @param aligned2 The buffer of the aligned second sequence (length1 + length2 + 1 characters).
+ * @param memoryBudget The bytes the directions of a segment may take.
+ * @return 0 on success, -1 if the checkpoints don't fit the scratch budget or the scratch file
+ * failed, or 1 if the memory allocation failed.
+ */
+int traceOutOfCore(ComparisonContext *context, int first, int second,
+                   char *aligned1, char *aligned2, size_t memoryBudget);
+/**
+ * @brief A function that creates an anonymous scratch file (removed as soon as it's closed).
+ * @param directory The directory of the scratch file.
+ * @return The file descriptor of the scratch file, or -1 if it couldn't be created.
+ */
+int openScratchFile(const char *directory);
+/**
+ * @brief A function that writes a whole buffer to a file at an offset.
+ * @param file The file descriptor.
+ * @param buffer The buffer.
+ * @param bytes The number of bytes to write.
+ * @param offset The offset in the file.
+ * @return 0 on success, -1 else.
+ */
+int writeFully(int file, const void *buffer, size_t bytes, off_t offset);
+/**
+ * @brief A function that reads a whole buffer from a file at an offset.
+ * @param file The file descriptor.
+ * @param buffer The buffer.
+ * @param bytes The number of bytes to read.
+ * @param offset The offset in the file.
+ * @return 0 on success, -1 else.
+ */
+int readFully(int file, void *buffer, size_t bytes, off_t offset);
+/**
+ * @brief A function that prints an optimal alignment of two sequences of the context, a line per
+ * aligned sequence. With a memory limit, the planner picks the traceback strategy (and falls back
+ * to the next one if an allocation fails). Else the directions are kept in memory if they fit the
+ * traceback memory budget, and are recomputed from checkpoints on a scratch file if they don't.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ */
+void printAlignment(ComparisonContext *context, int first, int second);
+/**
+ * @brief A function that traces an alignment of two sequences of the context with a strategy.
+ * @param context The comparison context.
+ * @param strategy The strategy (any but STRATEGY_SCORE_ONLY).
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param aligned1 The buffer of the aligned first sequence (length1 + length2 + 1 characters).
+ * @param aligned2 The buffer of the aligned second sequence (length1 + length2 + 1 characters).
+ * @param memoryBudget The bytes the strategy may take (bounds the out-of-core segments).
+ * @return 0 on success, -1 if the strategy doesn't fit its budgets, or 1 if the memory allocation
+ * failed.
+ */
+int traceWithStrategy(ComparisonContext *context, int strategy, int first, int second,
+                      char *aligned1, char *aligned2, size_t memoryBudget);
+/**
+ * @brief A function that returns the bytes a strategy takes for a pair (the traceback strategies
+ * count the aligned sequences too, and the out-of-core one its smallest segments).
+ * @param strategy The strategy.
+ * @param length1 The length of the first sequence.
+ * @param length2 The length of the second sequence.
+ * @param traceback Whether the pair is traced, or only scored.
+ * @return The bytes the strategy takes.
+ */
+size_t getStrategyBytes(int strategy, int length1, int length2, int traceback);
+/**
+ * @brief A function that picks the cheapest strategy for a pair whose memory fits the memory
+ * limit: for a traceback the full table, else the 2-bit directions, the out-of-core checkpoints
+ * and Hirschberg's linear space algorithm, else (and always without a traceback) only the score
+ * with a rolling row.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param traceback Whether the pair is traced, or only scored.
+ * @return The strategy.
+ */
+int planPair(const ComparisonContext *context, int first, int second, int traceback);
+/**
+ * @brief A function that reserves memory for a pair, waiting while other pairs hold too much of
+ * the memory limit for it to fit (a pair always gets its memory when no other pair holds any).
+ * @param context The comparison context.
+ * @param bytes The bytes to reserve.
+ */
+void reserveMemory(ComparisonContext *context, size_t bytes);
+/**
+ * @brief A function that releases the memory reserved for a pair, and wakes the pairs waiting for
+ * it.
+ * @param context The comparison context.
+ * @param bytes The bytes to release.
+ */
+void releaseMemory(ComparisonContext *context, size_t bytes);
+/**
+ * @brief A function that scores two sequences of the context with a rolling row, within the memory
+ * limit (the strategy the planner picks for a score).
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @return The score of the alignment of the two sequences.
+ */
+int scoreWithinMemoryLimit(ComparisonContext *context, int first, int second);
+/**
+ * @brief A function that allocates a table in two blocks (the row pointers and the cells), without
+ * exiting on failure.
+ * @param tableRows The number of rows in the table.
+ * @param tableColumns The number of columns in the table.
+ * @return The table, or NULL if the allocation failed.
+ */
+int **allocateTableBlock(int tableRows, int tableColumns);
+/**
+ * @brief A function that frees a table allocated by allocateTableBlock.
+ * @param table The table (may be NULL).
+ */
+void freeTableBlock(int **table);
+/**
+ * @brief A function that traces an alignment through a full table of scores, preferring the
+ * diagonal, then the gap in the second sequence, like the directions do.
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param aligned1 The buffer of the aligned first sequence (length1 + length2 + 1 characters).
+ * @param aligned2 The buffer of the aligned second sequence (length1 + length2 + 1 characters).
+ * @return 0 on success, 1 if the memory allocation failed.
+ */
+int traceFullTable(char *sequence1, int length1, char *sequence2, int length2, int m, int s, int g,
+                   char *aligned1, char *aligned2);
+/**
+ * @brief A function that traces an alignment in linear space with Hirschberg's algorithm: the
+ * first sequence is split in the middle, the column the optimal alignment crosses it at is found
+ * from a forward row of the top half and a backward row of the bottom half, and both halves are
+ * aligned recursively. Halves whose directions fit a small buffer are traced directly.
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param aligned1 The buffer of the aligned first sequence (length1 + length2 + 1 characters).
+ * @param aligned2 The buffer of the aligned second sequence (length1 + length2 + 1 characters).
+ * @return 0 on success, 1 if the memory allocation failed.
+ */
+int traceHirschberg(const char *sequence1, int length1, const char *sequence2, int length2,
+                    int m, int s, int g, char *aligned1, char *aligned2);
+/**
+ * @brief A function that appends the alignment of two sequences with Hirschberg's algorithm (see
+ * traceHirschberg).
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param rows A buffer for two rows (of length2 + 1 cells each).
+ * @param directions A buffer for the directions of the halves traced directly.
+ * @param directionsBytes The size of the directions buffer (at least a row of directions).
+ * @param aligned1 The aligned first sequence.
+ * @param aligned2 The aligned second sequence.
+ * @param lengthAddress A pointer to the length of the aligned sequences (updated).
+ */
+void alignHirschberg(const char *sequence1, int length1, const char *sequence2, int length2,
+                     int m, int s, int g, int *rows, unsigned char *directions,
+                     size_t directionsBytes, char *aligned1, char *aligned2, int *lengthAddress);
+/**
+ * @brief A function that computes the scores of aligning a sequence to every suffix of another
+ * sequence, keeping one row of the table from the end of both sequences.
+ * @param sequence1 The first sequence.
+ * @param length1 The length of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param row The row (of length2 + 1 cells), set to the score of aligning the first sequence to
+ * the suffix of the second sequence from every column.
+ */
+void fillSuffixRow(const char *sequence1, int length1, const char *sequence2, int length2,
+                   int m, int s, int g, int *row);
+/**
+ * @brief A function that compares only the pairs listed in a pair-list file, and prints their
+ * scores in the order of the file. The pairs are scheduled by their query sequence (the one with
+ * the smaller index), so the profile of every query is built once for all its pairs, and the scores
+ * are printed as soon as all the pairs before them in the file are scored.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param options The program options.
+ */
+void comparePairsList(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g, const ProgramOptions *options);
+/**
+ * @brief A function that reads a pair-list file: a pair per line, each sequence given by its name
+ * or by its 0-based index in the sequences file (names are matched first). Empty lines are skipped.
+ * @param file The pair-list file.
+ * @param sequencesNames The sequences names array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param pairsAddress A pointer to the array of pairs to allocate and fill.
+ * @param pairsCountAddress A pointer to the number of pairs.
+ * @return 0 on success, -1 if the memory allocation failed, or the number of the first invalid
+ * line.
+ */
+int readPairsList(FILE *file, char *sequencesNames[], int numberOfSequences,
+                  RequestedPair **pairsAddress, int *pairsCountAddress);
+/**
+ * @brief A function that finds a sequence by its name, or else by its 0-based index.
+ * @param token The name or the index.
+ * @param sequencesNames The sequences names array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @return The index of the sequence, or -1 if there is none.
+ */
+int findSequence(char *token, char *sequencesNames[], int numberOfSequences);
+/**
+ * @brief A comparison function of requested pairs for qsort, by query, then by target, then by
+ * their order in the file.
+ * @param first A pointer to the first pair.
+ * @param second A pointer to the second pair.
+ * @return A negative number, zero or a positive number if the first pair is scheduled before, with
+ * or after the second pair.
+ */
+int compareRequestedPairs(const void *first, const void *second);
+/**
+ * @brief A function that allocates memory like malloc, and with --mem-report charges it to a
+ * subsystem. The memory must be freed with trackedFree (or reallocated with trackedRealloc).
+ * @param bytes The number of bytes.
+ * @param subsystem The subsystem (MEMORY_*).
+ * @return The memory, or NULL if the allocation failed.
+ */
+void *trackedMalloc(size_t bytes, int subsystem);
+/**
+ * @brief A function that allocates zeroed memory like calloc, charged to a subsystem.
+ * @param count The number of elements.
+ * @param bytes The size of an element.
+ * @param subsystem The subsystem (MEMORY_*).
+ * @return The memory, or NULL if the allocation failed.
+ */
+void *trackedCalloc(size_t count, size_t bytes, int subsystem);
+/**
+ * @brief A function that reallocates tracked memory like realloc, charged to a subsystem.
+ * @param pointer The memory from trackedMalloc, trackedCalloc or trackedRealloc, or NULL.
+ * @param bytes The new number of bytes.
+ * @param subsystem The subsystem (MEMORY_*).
+ * @return The memory, or NULL if the allocation failed (then the old memory is kept).
+ */
+void *trackedRealloc(void *pointer, size_t bytes, int subsystem);
+/**
+ * @brief A function that frees tracked memory, and credits its subsystem.
+ * @param pointer The memory from trackedMalloc, trackedCalloc or trackedRealloc, or NULL.
+ */
+void trackedFree(void *pointer);
+/**
+ * @brief A function that adds to the live bytes of a subsystem and of the total, and raises
+ * their peaks.
+ * @param subsystem The subsystem (MEMORY_*).
+ * @param bytes The bytes allocated, or minus the bytes freed.
+ */
+void chargeMemory(int subsystem, long long bytes);
+/**
+ * @brief A function that raises a peak to a value, if it is higher.
+ * @param peak The peak.
+ * @param value The value.
+ */
+void raisePeak(long long *peak, long long value);
+/**
+ * @brief A function that prints the live and peak bytes and the allocations of every subsystem,
+ * the peak of all of them, and the peak resident set size of the process to stderr.
+ */
+void printMemoryReport(void);
+/**
+ * @brief A function that starts sampling the memory of the subsystems to a CSV file.
+ * @param fileName The path of the file.
+ * @return 0 on success, -1 if the file can't be opened or the thread can't be started.
+ */
+int startMemorySeries(const char *fileName);
+/**
+ * @brief A function that stops the sampling thread, takes a last sample and closes the file.
+ */
+void stopMemorySeries(void);
+/**
+ * @brief The function of the sampling thread: it samples the memory every
+ * MEMORY_SERIES_INTERVAL_NANOSECONDS until it is stopped.
+ * @param argument Unused.
+ * @return NULL.
+ */
+void *sampleMemoryPeriodically(void *argument);
+/**
+ * @brief A function that writes a CSV line with the time and the live bytes of every subsystem.
+ */
+void writeMemorySample(void);
+/**
+ * @brief A function that starts tracing (--trace): it allocates the trace buffers of the threads.
+ * @return 0 on success, -1 if the memory allocation failed.
+ */
+int startTrace(void);
+/**
+ * @brief A function that takes the begin time of a traced event.
+ * @return The current time in nanoseconds, or 0 without --trace.
+ */
+long long beginTrace(void);
+/**
+ * @brief A function that records an event in the trace buffer of the calling thread, if --trace is
+ * given.
+ * @param name The name of the event (a string literal).
+ * @param begin The time the event began, from beginTrace.
+ * @param first The index of the first sequence of the pair of the event, or -1.
+ * @param second The index of the second sequence of the pair of the event, or -1.
+ */
+void endTrace(const char *name, long long begin, int first, int second);
+/**
+ * @brief A function that writes the traced events as Chrome trace event JSON (which Perfetto and
+ * chrome://tracing load), and frees the trace buffers.
+ * @param fileName The path of the trace file.
+ * @return 0 on success, -1 if the file can't be written.
+ */
+int writeTrace(const char *fileName);
+/**
+ * @brief A function that adds the time since a mark to a phase, if --stats is given.
+ * @param context The comparison context.
+ * @param phase The phase (PHASE_*), or PHASE_NONE to only take the mark.
+ * @param mark The time the phase started, in nanoseconds.
+ * @return The current time in nanoseconds (the next mark), or 0 without --stats.
+ */
+long long markPhase(ComparisonContext *context, int phase, long long mark);
+/**
+ * @brief A function that records how the score of a pair was computed, for --stats.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ * @param nanoseconds The time spent computing the score.
+ * @param kernel The name of the kernel that computed it, or NULL for the one alignPair uses.
+ */
+void recordPairStatistics(ComparisonContext *context, int first, int second,
+                          long long nanoseconds, const char *kernel);
+/**
+ * @brief A function that writes the time of every phase and a CSV line for every pair of the run
+ * (lengths, cells, kernel, precision, pruned, source and nanoseconds) to the stats file, and a
+ * summary of the phases to stderr.
+ * @param context The comparison context.
+ * @param fileName The path of the stats file.
+ * @return 0 on success, -1 if the file can't be written.
+ */
+int writeStatistics(const ComparisonContext *context, const char *fileName);
+/**
+ * @brief A function that writes a CSV field, quoted if needed.
+ * @param file The file.
+ * @param field The field.
+ */
+void writeCsvField(FILE *file, const char *field);
+/**
+ * @brief A function that starts reporting the progress of the run (if --progress is given): it
+ * sums the cells of the pairs to compare, and starts the reporter thread.
+ * @param context The comparison context.
+ * @param sharedSeeds The shared minimizers counts, or NULL if there is no prefilter.
+ */
+void startProgress(ComparisonContext *context, const int *sharedSeeds);
+/**
+ * @brief A function that stops the reporter thread, and reports the final progress.
+ * @param context The comparison context.
+ */
+void stopProgress(ComparisonContext *context);
+/**
+ * @brief The function of the reporter thread: it reports the progress every second until it is
+ * stopped.
+ * @param argument The comparison context.
+ * @return NULL.
+ */
+void *reportProgressPeriodically(void *argument);
+/**
+ * @brief A function that reports the pairs and cells done, the throughput since the last report
+ * in GCUPS (billions of cell updates per second), and the time left estimated from the cells left.
+ * @param context The comparison context.
+ */
+void reportProgress(ComparisonContext *context);
+/**
+ * @brief A function that adds to the progress counters of the calling thread.
+ * @param context The comparison context.
+ * @param pairs The number of pairs done.
+ * @param cells The cells of the pairs done.
+ * @param computedCells The cells computed.
+ */
+void countProgress(ComparisonContext *context, long long pairs, long long cells,
+                   long long computedCells);
+/**
+ * @brief A function that computes the scores of all the pairs that need an alignment with several
+ * threads, before they are printed in the usual order.
+ * @param context The comparison context.
+ * @param sharedSeeds The shared minimizers counts, or NULL if there is no prefilter.
+ */
+void scorePairsParallel(ComparisonContext *context, const int *sharedSeeds);
+/**
+ * @brief The function of a thread scoring pairs in parallel: it takes the next pair until there
+ * are none left.
+ * @param argument The parallel scoring.
+ * @return NULL.
+ */
+void *scorePairsWorker(void *argument);
+/**
+ * @brief A function that starts the alignment of an (empty) growing sequence to a sequence.
+ * @param alignment The alignment to start.
+ * @param sequence2 The second sequence (it must outlive the alignment).
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @return 0 on success, -1 if the memory allocation failed.
+ */
+int startExtensibleAlignment(ExtensibleAlignment *alignment, const char *sequence2, int length2,
+                             int m, int s, int g);
+/**
+ * @brief A function that appends residues to the first sequence of an alignment, computing only
+ * the new rows of the table (count * length2 cells).
+ * @param alignment The alignment.
+ * @param residues The residues to append.
+ * @param count The number of residues.
+ * @return The score of the alignment of the extended first sequence to the second sequence.
+ */
+int extendAlignment(ExtensibleAlignment *alignment, const char *residues, int count);
+/**
+ * @brief A function that frees the memory allocated for an extensible alignment.
+ * @param alignment The alignment.
+ */
+void freeExtensibleAlignment(ExtensibleAlignment *alignment);
+/**
+ * @brief A function that aligns a sequence growing on the standard input to every sequence of the
+ * file. Every line of residues extends the sequence, and the updated scores are printed after it.
+ * A header line ('>' and a name) starts a new sequence.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ */
+void streamExtensions(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g);
+/**
+ * @brief A function that serves the scores of queries against the sequences of the file on a Unix
+ * socket, until SIGINT or SIGTERM. The sequences are read once, and every worker thread keeps its
+ * aligner between queries. On connecting, a client gets the number of sequences, and then the
+ * length and bytes of the name and the length of the sequence of each of them. A request is the
+ * length of a query followed by its residues; its response is a status (ALIGNER_SUCCESS or an
+ * ALIGNER_* error) followed, on success, by the score of the query against every sequence. Every
+ * number is a 32 bit integer in network byte order. The queries of all the clients are answered
+ * in parallel, and the requests of one client in order. The client sockets don't block: the main
+ * thread sends every response as the client reads it, so a client that doesn't read holds up only
+ * itself. A query longer than SERVE_MAXIMAL_QUERY_LENGTH closes its connection. Every query is
+ * scored on its own, even when several are queued.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param options The program options (the socket and the number of threads are taken from them).
+ */
+void serveScores(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                 int m, int s, int g, const ProgramOptions *options);
+/**
+ * @brief A function that opens a Unix socket listening on a path (a socket left on the path by a
+ * previous server is replaced).
+ * @param path The path.
+ * @return The socket, or -1 on failure.
+ */
+int openServerSocket(const char *path);
+/**
+ * @brief A function that builds the greeting of the server: the number of database sequences, and
+ * the name and length of each of them.
+ * @param server The server, with its database.
+ * @param sequencesNames The names of the database sequences.
+ * @return 0 on success, -1 if the memory allocation failed.
+ */
+int buildServerGreeting(ScoreServer *server, char *sequencesNames[]);
+/**
+ * @brief A function that accepts a client into a free slot, makes its socket non-blocking, and
+ * queues the greeting to it.
+ * @param server The server.
+ * @param listener The listening socket.
+ */
+void acceptServerClient(ScoreServer *server, int listener);
+/**
+ * @brief A function that reads what a client sent of its request, without blocking for the rest.
+ * @param connection The client.
+ * @return 1 if the request is read in full, 0 if more is to come, -1 if the client closed the
+ * connection or sent an invalid request.
+ */
+int readServerRequest(ServerConnection *connection);
+/**
+ * @brief A function that sends what the socket of a client takes of its output, without blocking.
+ * @param connection The client.
+ * @return 0 if the output was sent or more is to send, -1 if the client closed the connection.
+ */
+int sendServerOutput(ServerConnection *connection);
+/**
+ * @brief A function that closes a client and frees its query and response.
+ * @param connection The client.
+ */
+void closeServerClient(ServerConnection *connection);
+/**
+ * @brief The function of a thread answering the queries of the server queue.
+ * @param argument The worker.
+ * @return NULL.
+ */
+void *serveScoresWorker(void *argument);
+/**
+ * @brief A function that scores the query of a client against the database, and makes the
+ * response the output of the client.
+ * @param worker The worker.
+ * @param connection The client.
+ */
+void answerServerQuery(ServerWorker *worker, ServerConnection *connection);
+/**
+ * @brief The handler of SIGINT and SIGTERM while serving: it stops the server.
+ * @param signalNumber The signal.
+ */
+void stopServing(int signalNumber);
+/**
+ * @brief A function that computes the score of an alignment of two sequences that goes through a
+ * colinear chain of exact k-mer anchors, aligning only the gaps between the anchors with the
+ * dynamic programming algorithm. The score is a lower bound of the exact score.
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param sequence1 The first sequence to compare.
+ * @param sequence2 The second sequence to compare.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ * @param kmerLength The length of the k-mers the anchors are found from.
+ * @param anchorsCountAddress A pointer to the number of anchors in the chain.
+ * @return The score of the anchored alignment.
+ */
+int scoreAnchored(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                  char *sequence1, char *sequence2, int m, int s, int g, int kmerLength,
+                  int *anchorsCountAddress);
+/**
+ * @brief A function that finds the exact matches between two sequences that start with a k-mer
+ * appearing once in the second sequence, merging overlapping hits on the same diagonal.
+ * @param sequence1 The first sequence.
+ * @param kmerHashes1 The hashes of the k-mers of the first sequence.
+ * @param kmersCount1 The number of k-mers of the first sequence.
+ * @param sequence2 The second sequence.
+ * @param kmers2 The k-mers of the second sequence, sorted by hash.
+ * @param kmersCount2 The number of k-mers of the second sequence.
+ * @param kmerLength The length of the k-mers.
+ * @param anchors The array to write the anchors to, sorted by their position in sequence1.
+ * @return The number of anchors found.
+ */
+int findAnchors(const char *sequence1, const uint64_t *kmerHashes1, int kmersCount1,
+                const char *sequence2, const KmerPosition *kmers2, int kmersCount2,
+                int kmerLength, Anchor *anchors);
+/**
+ * @brief A function that chooses the best colinear chain of anchors with a dynamic programming
+ * over the anchors (each anchor looks back at a bounded number of predecessors). Every shift of
+ * diagonal between consecutive anchors, and from the corners of the table, costs a gap, so a chain
+ * that can't beat the diagonal of the table is dropped.
+ * @param anchors The anchors, sorted by their position in the first sequence.
+ * @param anchorsCount The number of anchors.
+ * @param length1 The length of the first sequence.
+ * @param length2 The length of the second sequence.
+ * @param m The weight of a match.
+ * @param g The weight of a gap.
+ * @param chainScores A buffer for the best chain score ending at each anchor.
+ * @param predecessors A buffer for the previous anchor in the best chain ending at each anchor.
+ * @param chain The array to write the indices of the chosen anchors to, in order.
+ * @return The number of anchors in the chosen chain.
+ */
+int chainAnchors(const Anchor *anchors, int anchorsCount, int length1, int length2, int m, int g,
+                 long long *chainScores, int *predecessors, int *chain);
+/**
+ * @brief A comparison function of k-mer positions for qsort, by hash and then by position.
+ * @param first A pointer to the first k-mer position.
+ * @param second A pointer to the second k-mer position.
+ * @return A negative number, zero or a positive number if the first k-mer position is smaller,
+ * equal or larger than the second one.
+ */
+int compareKmerPositions(const void *first, const void *second);
+/**
+ * @brief A function that compares two sequences using a dynamic programming algorithm, and prints
+ * their score and match.
+ * @param context The comparison context.
+ * @param first The index of the first sequence.
+ * @param second The index of the second sequence.
+ */
+void compareTwoSequences(ComparisonContext *context, int first, int second);
+/**
+ * @brief A function that frees the memory allocated for the sequences array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ */
+void freeSequencesMemory(char *sequences[], int numberOfSequences);
+/**
+ * @brief A function that flags a failed allocation of a pair's workspace for the thread joining the
+ * caller, if the caller is a worker thread (the main thread reports and exits by itself).
+ * @return 1 if the caller is a worker thread, which returns without the score, 0 else.
+ */
+int flagWorkerFailure(void);
+/**
+ * @brief A function that allocates memory for the table used in the dynamic algorithm to compare
+ * two sequences (if the allocation failed, the function frees the memory aready allocated by the
+ * program, or in a worker thread flags the failure and leaves the table NULL).
+ * @param sequencesNames The sequences names array.
+ * @param sequences The sequences array.
+ * @param numberOfSequences The number of sequences in the array.
+ * @param tableAddress A pointer to the table.
+ * @param tableRows The number of rows in the table.
+ * @param tableColumns The number of columns in the table.
+ */
+void allocateTable(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                   int ***tableAddress, int tableRows, int tableColumns);
+/**
+ * @brief A function that fills the table used in the dynamic algorithm to compare two sequences.
+ * @param sequence1 The first sequence compared.
+ * @param sequence2 The second sequence compared.
+ * @param table The (empty) table.
+ * @param tableRows The number of rows in the table.
+ * @param tableColumns The number of columns in the table.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ */
+void fillTable(char *sequence1, char *sequence2, int **table,
+               int tableRows, int tableColumns, int m, int s, int g);
+/**
+ * brief A function that initializes the table used in the dynamic algorithm to compare two
+ * sequences.
+ * @param table The (empty) talbe.
+ * @param tableRows The number of rows in the table.
+ * @param tableColumns The number of columns in the table.
+ * @param g The weight of a gap.
+ */
+void initializeTable(int **table, int tableRows, int tableColumns, int g);
+/**
+ * @brief A function that fills a cell in the table used in the dynamic algorithm to compare two
+ * sequences.
+ * @param sequence1 The first sequence compared.
+ * @param sequence2 The second sequence compared.
+ * @param table The table.
+ * @param row The number of row of the cell.
+ * @param column The number of column of the cell.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @param g The weight of a gap.
+ */
+void fillTableCell(char *sequence1, char *sequence2, int **table,
+                   int row, int column, int m, int s, int g);
+/**
+ * @brief A function that computes the first opportunity for a cell in the table used in the
+ * dynamic algorithm to compare two sequences (according to the exercise PDF).
+ * @param sequence1 The first sequence compared.
+ * @param sequence2 The second sequence compared.
+ * @param table The table.
+ * @param row The number of row of the cell.
+ * @param column The number of column of the cell.
+ * @param m The weight of a match.
+ * @param s The weight of a mismatch.
+ * @return  The first opportunity for a cell in the table used in the dynamic algorithm to compare
+ * two sequences (according to the exercise PDF).
+ */
+int computeFirstMatchScore(char *sequence1, char *sequence2, int **table,
+                           int row, int column, int m, int s);
+/**
+ * @brief A function that computes the second opportunity for a cell in the table used in the
+ * dynamic algorithm to compare two sequences (according to the exercise PDF).
+ * @param table The table.
+ * @param row The number of row of the cell.
+ * @param column The number of column of the cell.
+ * @param g The weight of a gap.
+ * @return The second opportunity for a cell in the table used in the dynamic algorithm to compare
+ * two sequences (according to the exercise PDF).
+ */
+int computeSecondMatchScore(int **table, int row, int column, int g);
+/**
+ * @brief A function that computes the third opportunity for a cell in the table used in the
+ * dynamic algorithm to compare two sequences (according to the exercise PDF).
+ * @param table The table.
+ * @param row The number of row of the cell.
+ * @param column The number of column of the cell.
+ * @param g The weight of a gap.
+ * @return The third opportunity for a cell in the table used in the dynamic algorithm to compare
+ * two sequences (according to the exercise PDF).
+ */
+int computeThirdMatchScore(int **table, int row, int column, int g);
+/**
+ * @brief A function that computes the maximum of three integers.
+ * @param n1 The first integer.
+ * @param n2 The second integer.
+ * @param n3 The third integer.
+ * @return The maximum of the three integers.
+ */
+int max3(int n1, int n2, int n3);
+/**
+ * @brief A function that computes the maximum of two numbers.
+ * @param n1 The first number.
+ * @param n2 The second number.
+ * @return The maximum of the two numbers.
+ */
+int max(int n1, int n2);
+/**
+ * @brief A function that prints the score of the comparison of two sequences.
+ * @param score The score of the alignment of the two sequences.
+ * @param sequence1Name The name of the first sequence in the sequences array.
+ * @param sequence2Name The name of the second sequence in the sequences array.
+ */
+void printScore(int score, char *sequence1Name, char *sequence2Name);
+/**
+ * @brief A function that frees the memory allocated for the table used in the dynamic algorithm to
+ * compare two sequences.
+ * @param table The table.
+ * @param tableRows The number of rows in the table.
+ */
+void freeTableMemory(int **table, int tableRows);
+
+// -------------------------------------------- globals -------------------------------------------
+/**
+ * @brief The profile kernel chosen at startup.
+ */
+ProfileKernel profileKernel = scoreWithProfile;
+/**
+ * @brief The engine of the profile kernel chosen at startup, which scores the exact pairs.
+ */
+int profileEngine = ENGINE_FIRST_PROFILE;
+/**
+ * @brief The slot of the thread in the progress counters and trace buffers (0 for the main thread).
+ */
+__thread int threadSlot = 0;
+/**
+ * @brief Whether a worker thread failed to allocate the workspace of a pair, for the thread joining
+ * it to report.
+ */
+int workerFailed = 0;
+/**
+ * @brief The trace buffers of the main thread and of every worker thread, or NULL without --trace.
+ */
+TraceBuffer *traceBuffers = NULL;
+/**
+ * @brief The time the trace started, in nanoseconds.
+ */
+long long traceStart = 0;
+/**
+ * @brief Whether the tracked allocations are charged to their subsystems (--mem-report). It is set
+ * before the first allocation, so every tracked block either has a header or none does.
+ */
+int memoryReport = 0;
+/**
+ * @brief The memory of every subsystem, and of all of them.
+ */
+MemoryAccount memoryAccounts[MEMORY_SUBSYSTEMS_COUNT], memoryTotal;
+/**
+ * @brief The sampling of the memory (--mem-series).
+ */
+MemorySeries memorySeries = {NULL, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0};
+/**
+ * @brief Whether SIGINT or SIGTERM asked the server to stop (--serve).
+ */
+volatile sig_atomic_t servingStopped = 0;
+/**
+ * @brief The write end of the wake pipe of the server, for the signal handler (--serve).
+ */
+int servingWakeDescriptor = -1;
+
+/**
+ * @brief The main function of the program. The function checks the validity of the usage of the
+ * program, reads the sequences file, compares each pair of sequences in the file (using a dynamic
+ * programming algorithm), and prints the score and the match for each pair.
+ * @param argc The number of program arguments.
+ * @param argv The program arguments.
+ * @return 0 if the function succeed, -1 else.
+ */
+int main(int argc, char *argv[])
+{
+    char *fileName = NULL;
+    int m, s, g;
+    ProgramOptions options;
+    if (argc > 1 && strcmp(argv[1], MERGE_COMMAND) == 0)
+    {
+        if (mergeShards(argc - 2, argv + 2))
+        {
+            fprintf(stderr, "Error - the partial results don't make a complete run\n");
+            return -1;
+        }
+        return 0;
+    }
+    int usage = checkUsage(argc, argv, &fileName, &m, &s, &g, &options);
+    if (usage) // if the usage is wrong
+    {
+        fprintf(stdout, "Usage: CompareSequences <path_to_sequences_file> <m> <s> <g>\n");
+        return -1;
+    }
+    if (selectProfileKernel(options.isaName))
+    {
+        fprintf(stderr, "Error - unknown or unsupported instruction set\n");
+        return -1;
+    }
+    char *sequencesNames[MAXIMAL_NUMBER_OF_SEQUENCES];
+    char *sequences[MAXIMAL_NUMBER_OF_SEQUENCES];
+    int numberOfSequences = 0;
+    memoryReport = options.memoryReport;
+    if (options.memorySeriesFileName != NULL && startMemorySeries(options.memorySeriesFileName))
+    {
+        fprintf(stderr, "Error opening memory series file\n");
+    }
+    if (options.traceFileName != NULL && startTrace())
+    {
+        fprintf(stderr, "Trace: not recorded, the memory allocation failed\n");
+    }
+    long long parseStart = getTimeNanoseconds();
+    readSequencesFile(fileName, sequencesNames, sequences, &numberOfSequences);
+    options.parseTime = getTimeNanoseconds() - parseStart;
+    endTrace("parse", parseStart, -1, -1);
+    if (options.databaseFileName != NULL)
+    {
+        char *databaseNames[MAXIMAL_NUMBER_OF_SEQUENCES];
+        char *database[MAXIMAL_NUMBER_OF_SEQUENCES];
+        int databaseCount = 0;
+        readSequencesFile(options.databaseFileName, databaseNames, database, &databaseCount);
+        compareQueriesToDatabase(sequencesNames, sequences, numberOfSequences,
+                                 databaseNames, database, databaseCount, m, s, g, &options);
+        freeSequencesMemory(databaseNames, databaseCount);
+        freeSequencesMemory(database, databaseCount);
+    }
+    else if (options.serveSocketName != NULL)
+    {
+        serveScores(sequencesNames, sequences, numberOfSequences, m, s, g, &options);
+    }
+    else if (options.extend)
+    {
+        streamExtensions(sequencesNames, sequences, numberOfSequences, m, s, g);
+    }
+    else if (options.pairsFileName != NULL)
+    {
+        comparePairsList(sequencesNames, sequences, numberOfSequences, m, s, g, &options);
+    }
+    else if (numberOfSequences < MINIMAL_NUMBER_OF_SEQUENCES)
+    {
+        fprintf(stderr, "Error - the sequences file contains less than 2 sequences\n");
+    }
+    else if (options.bench)
+    {
+        benchmarkEngines(sequencesNames, sequences, numberOfSequences, m, s, g, &options);
+    }
+    else
+    {
+        compareSequences(sequencesNames, sequences, numberOfSequences, m, s, g, &options);
+    }
+    if (traceBuffers != NULL)
+    {
+        long long flushBegin = beginTrace();
+        fflush(stdout);
+        endTrace("output flush", flushBegin, -1, -1);
+        if (writeTrace(options.traceFileName))
+        {
+            fprintf(stderr, "Error writing trace file\n");
+        }
+    }
+    freeSequencesMemory(sequencesNames, numberOfSequences);
+    freeSequencesMemory(sequences, numberOfSequences);
+    if (memorySeries.file != NULL)
+    {
+        stopMemorySeries();
+    }
+    if (memoryReport)
+    {
+        printMemoryReport();
+    }
+    return 0;
+}
+
+int checkUsage(int argc, char *argv[], char **fileNameAddress,
+               int *mAddress, int *sAddress, int *gAddress, ProgramOptions *options)
+{
+    char *arguments[NUMBER_OF_ARGUMENTS];
+    int argumentsCount = 0;
+    if (checkOptions(argc, argv, options, arguments, &argumentsCount))
+    {
+        return -1;
+    }
+    // with both --query and --db the sequences file argument is omitted
+    int shift = 0;
+    if (options->queryFileName != NULL && options->databaseFileName != NULL &&
+        argumentsCount == NUMBER_OF_ARGUMENTS - 1)
+    {
+        *fileNameAddress = options->queryFileName;
+        shift = 1;
+    }
+    else if (argumentsCount == NUMBER_OF_ARGUMENTS && options->queryFileName == NULL)
+    {
+        *fileNameAddress = arguments[FILE_NAME_INDEX];
+    }
+    else
+    {
+        return -1;
+    }
+    if (checkNumber(arguments[M_INDEX - shift], mAddress) ||
+        checkNumber(arguments[S_INDEX - shift], sAddress) ||
+        checkNumber(arguments[G_INDEX - shift], gAddress))
+    {
+        return -1;
+    }
+    options->sweepWeights[0][0] = *mAddress;
+    options->sweepWeights[0][1] = *sAddress;
+    options->sweepWeights[0][2] = *gAddress;
+    return 0;
+}
+
+int checkOptions(int argc, char *argv[], ProgramOptions *options, char *arguments[],
+                 int *argumentsCountAddress)
+{
+    options->prefilter = 0;
+    options->kmerLength = DEFAULT_KMER_LENGTH;
+    options->windowLength = DEFAULT_WINDOW_LENGTH;
+    options->minimalSharedSeeds = DEFAULT_MINIMAL_SHARED_SEEDS;
+    options->prefilterCheck = 0;
+    options->prefilterCheckThreshold = 0;
+    options->anchored = 0;
+    options->anchoredCheck = 0;
+    options->noDeduplication = 0;
+    options->cacheFileName = NULL;
+    options->cacheCapacity = DEFAULT_CACHE_CAPACITY;
+    options->matrixOutputFileName = NULL;
+    options->previousMatrixFileName = NULL;
+    options->extend = 0;
+    options->sweepWeightsCount = 0;
+    options->queryFileName = NULL;
+    options->databaseFileName = NULL;
+    options->tiled = 0;
+    options->isaName = NULL;
+    options->autoTune = 0;
+    options->planFileName = NULL;
+    options->alignment = 0;
+    options->tracebackMemory = DEFAULT_TRACEBACK_MEMORY;
+    options->scratchDirectory = DEFAULT_SCRATCH_DIRECTORY;
+    options->scratchLimit = 0;
+    options->memoryLimit = 0;
+    options->threads = DEFAULT_THREADS;
+    options->pairsFileName = NULL;
+    options->shardIndex = 0;
+    options->shardsCount = 1;
+    options->checkpointPrefix = NULL;
+    options->checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+    options->resume = 0;
+    options->progress = 0;
+    options->progressFileName = NULL;
+    options->statsFileName = NULL;
+    options->traceFileName = NULL;
+    options->bench = 0;
+    options->perf = 0;
+    options->memoryReport = 0;
+    options->memorySeriesFileName = NULL;
+    options->serveSocketName = NULL;
+    options->parseTime = 0;
+    arguments[0] = argv[0];
+    *argumentsCountAddress = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], OPTION_PREFIX, strlen(OPTION_PREFIX)) != 0)
+        {
+            if (*argumentsCountAddress == NUMBER_OF_ARGUMENTS)
+            {
+                return -1;
+            }
+            arguments[(*argumentsCountAddress)++] = argv[i];
+            continue;
+        }
+        char *option = argv[i] + strlen(OPTION_PREFIX);
+        if (strcmp(option, "prefilter") == 0)
+        {
+            options->prefilter = 1;
+        }
+        else if (strcmp(option, "kmer") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->kmerLength) ||
+                options->kmerLength > MAXIMAL_KMER_LENGTH)
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "window") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->windowLength))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "min-seeds") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->minimalSharedSeeds))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "prefilter-check") == 0)
+        {
+            if (i + 1 >= argc || checkNumber(argv[++i], &options->prefilterCheckThreshold))
+            {
+                return -1;
+            }
+            options->prefilterCheck = 1;
+        }
+        else if (strcmp(option, "anchored") == 0)
+        {
+            options->anchored = 1;
+        }
+        else if (strcmp(option, "anchored-check") == 0)
+        {
+            options->anchored = 1;
+            options->anchoredCheck = 1;
+        }
+        else if (strcmp(option, "no-dedup") == 0)
+        {
+            options->noDeduplication = 1;
+        }
+        else if (strcmp(option, "extend") == 0)
+        {
+            options->extend = 1;
+        }
+        else if (strcmp(option, "tiled") == 0)
+        {
+            options->tiled = 1;
+        }
+        else if (strcmp(option, "alignment") == 0)
+        {
+            options->alignment = 1;
+        }
+        else if (strcmp(option, "traceback-memory") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->tracebackMemory))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "scratch-dir") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->scratchDirectory))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "scratch-limit") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->scratchLimit))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "mem-limit") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->memoryLimit))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "threads") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->threads) ||
+                options->threads > MAXIMAL_THREADS)
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "pairs") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->pairsFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "shard") == 0)
+        {
+            char extra = 0;
+            if (i + 1 >= argc ||
+                sscanf(argv[++i], "%d/%d%c", &options->shardIndex, &options->shardsCount,
+                       &extra) != 2 ||
+                options->shardsCount < 1 || options->shardsCount > MAXIMAL_SHARDS ||
+                options->shardIndex < 1 || options->shardIndex > options->shardsCount)
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "checkpoint") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->checkpointPrefix))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "checkpoint-interval") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->checkpointInterval))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "resume") == 0)
+        {
+            options->resume = 1;
+        }
+        else if (strcmp(option, "progress") == 0)
+        {
+            options->progress = 1;
+        }
+        else if (strcmp(option, "progress-file") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->progressFileName))
+            {
+                return -1;
+            }
+            options->progress = 1;
+        }
+        else if (strcmp(option, "mem-report") == 0)
+        {
+            options->memoryReport = 1;
+        }
+        else if (strcmp(option, "serve") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->serveSocketName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "mem-series") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->memorySeriesFileName))
+            {
+                return -1;
+            }
+            options->memoryReport = 1;
+        }
+        else if (strcmp(option, "bench") == 0)
+        {
+            options->bench = 1;
+        }
+        else if (strcmp(option, "perf") == 0)
+        {
+            options->perf = 1;
+        }
+        else if (strcmp(option, "trace") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->traceFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "stats") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->statsFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "auto") == 0)
+        {
+            options->autoTune = 1;
+        }
+        else if (strcmp(option, "plan") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->planFileName))
+            {
+                return -1;
+            }
+            options->autoTune = 1;
+        }
+        else if (strcmp(option, "weights") == 0)
+        {
+            if (i + 1 >= argc || options->sweepWeightsCount == MAXIMAL_SWEEP_WEIGHTS ||
+                checkWeightsTriple(argv[++i],
+                                   options->sweepWeights[options->sweepWeightsCount + 1]))
+            {
+                return -1;
+            }
+            options->sweepWeightsCount++;
+        }
+        else if (strcmp(option, "cache") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->cacheFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "isa") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->isaName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "query") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->queryFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "db") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->databaseFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "matrix-out") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->matrixOutputFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "previous") == 0)
+        {
+            if (checkStringOptionValue(argc, argv, &i, &options->previousMatrixFileName))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(option, "cache-size") == 0)
+        {
+            if (checkPositiveOptionValue(argc, argv, &i, &options->cacheCapacity))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    // a run resumes from its checkpoint, and a tiled run scores every pair exactly with the
+    // profile kernel
+    if ((options->resume && options->checkpointPrefix == NULL) ||
+        (options->tiled && (options->anchored || options->autoTune || options->memoryLimit > 0)))
+    {
+        return -1;
+    }
+    // the queries are scored exactly against the whole database, and only their scores are
+    // printed
+    if (options->databaseFileName != NULL &&
+        (options->anchored || options->prefilter || options->prefilterCheck ||
+         options->cacheFileName != NULL || options->matrixOutputFileName != NULL ||
+         options->previousMatrixFileName != NULL || options->checkpointPrefix != NULL ||
+         options->shardIndex > 0 || options->tiled || options->alignment ||
+         options->autoTune || options->memoryLimit > 0 || options->progress ||
+         options->statsFileName != NULL || options->perf || options->serveSocketName != NULL ||
+         options->extend || options->bench))
+    {
+        return -1;
+    }
+    // the pairs of a pairs file are scored exactly, on one thread, and only their scores are
+    // printed, in the order of the file
+    if (options->pairsFileName != NULL &&
+        (options->anchored || options->prefilter || options->prefilterCheck ||
+         options->matrixOutputFileName != NULL || options->checkpointPrefix != NULL ||
+         options->shardIndex > 0 || options->tiled || options->threads > 1 ||
+         options->alignment || options->autoTune || options->memoryLimit > 0 ||
+         options->progress || options->statsFileName != NULL || options->perf ||
+         options->databaseFileName != NULL || options->serveSocketName != NULL ||
+         options->extend || options->bench))
+    {
+        return -1;
+    }
+    // a weights sweep scores every pair of the file exactly, on one thread, and prints only the
+    // scores of every triple
+    if (options->sweepWeightsCount > 0 &&
+        (options->anchored || options->prefilter || options->prefilterCheck ||
+         options->cacheFileName != NULL || options->matrixOutputFileName != NULL ||
+         options->previousMatrixFileName != NULL || options->checkpointPrefix != NULL ||
+         options->shardIndex > 0 || options->tiled || options->threads > 1 ||
+         options->alignment || options->autoTune || options->memoryLimit > 0 ||
+         options->progress || options->statsFileName != NULL || options->perf ||
+         options->pairsFileName != NULL || options->databaseFileName != NULL ||
+         options->serveSocketName != NULL || options->extend || options->bench))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int checkStringOptionValue(int argc, char *argv[], int *indexAddress, char **valueAddress)
+{
+    if (*indexAddress + 1 >= argc)
+    {
+        return -1;
+    }
+    (*indexAddress)++;
+    *valueAddress = argv[*indexAddress];
+    return 0;
+}
+
+int checkPositiveOptionValue(int argc, char *argv[], int *indexAddress, int *valueAddress)
+{
+    if (*indexAddress + 1 >= argc)
+    {
+        return -1;
+    }
+    (*indexAddress)++;
+    if (checkNumber(argv[*indexAddress], valueAddress) || *valueAddress <= 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void compareQueriesToDatabase(char *queryNames[], char *queries[], int queriesCount,
+                              char *databaseNames[], char *database[], int databaseCount,
+                              int m, int s, int g, const ProgramOptions *options)
+{
+    unsigned char residueCodes[ALPHABET_SIZE] = {0};
+    char seen[ALPHABET_SIZE] = {0};
+    int alphabetSize = 0, maximalQueryLength = 0;
+    int *queryLengths = (int *)malloc((queriesCount + 1) * sizeof(int));
+    int *databaseLengths = (int *)malloc((databaseCount + 1) * sizeof(int));
+    QueryProfile *profiles = (QueryProfile *)calloc((size_t)queriesCount + 1,
+                                                    sizeof(QueryProfile));
+    int *blockScores = (int *)trackedMalloc(((size_t)queriesCount * databaseCount + 1) *
+                                            sizeof(int), MEMORY_OUTPUT);
+    int failed = queryLengths == NULL || databaseLengths == NULL || profiles == NULL ||
+                 blockScores == NULL;
+    // the residues are renumbered densely, so a profile has one row per residue actually used
+    for (int i = 0; !failed && i < queriesCount + databaseCount; i++)
+    {
+        const char *sequence = i < queriesCount ? queries[i] : database[i - queriesCount];
+        int length = (int)strlen(sequence);
+        alphabetSize = addToAlphabet(sequence, length, residueCodes, seen, alphabetSize);
+        if (i < queriesCount)
+        {
+            queryLengths[i] = length;
+            maximalQueryLength = length > maximalQueryLength ? length : maximalQueryLength;
+        }
+        else
+        {
+            databaseLengths[i - queriesCount] = length;
+        }
+    }
+    DatabaseScoring scoring;
+    scoring.profiles = profiles;
+    scoring.database = database;
+    scoring.databaseLengths = databaseLengths;
+    scoring.databaseCount = databaseCount;
+    scoring.residueCodes = residueCodes;
+    scoring.g = g;
+    scoring.maximalQueryLength = maximalQueryLength;
+    scoring.blockScores = blockScores;
+    scoring.failed = 0;
+    pthread_t threads[MAXIMAL_THREADS];
+    for (int first = 0; !failed && first < queriesCount;)
+    {
+        // a block takes queries until their profiles fill the cache budget (at least one query)
+        int last = first;
+        size_t blockBytes = 0;
+        do
+        {
+            size_t profileBytes = (size_t)alphabetSize * queryLengths[last] * sizeof(int);
+            profiles[last].length = queryLengths[last];
+            profiles[last].scores = (int *)trackedMalloc(profileBytes + sizeof(int),
+                                                          MEMORY_WORKSPACE);
+            failed = profiles[last].scores == NULL;
+            if (!failed)
+            {
+                buildQueryProfile(queries[last], queryLengths[last], residueCodes, alphabetSize,
+                                  m, s, &profiles[last]);
+            }
+            blockBytes += profileBytes;
+            last++;
+        } while (!failed && last < queriesCount && blockBytes < QUERY_BLOCK_BYTES);
+        // the main thread scores too, so a single thread starts none
+        scoring.firstQuery = first;
+        scoring.lastQuery = last;
+        scoring.nextTarget = 0;
+        int threadsCount = 0;
+        while (!failed && threadsCount < options->threads - 1 &&
+               pthread_create(&threads[threadsCount], NULL, scoreDatabaseWorker, &scoring) == 0)
+        {
+            threadsCount++;
+        }
+        if (!failed)
+        {
+            scoreDatabaseWorker(&scoring);
+        }
+        for (int thread = 0; thread < threadsCount; thread++)
+        {
+            pthread_join(threads[thread], NULL);
+        }
+        failed = failed || scoring.failed;
+        for (int query = first; !failed && query < last; query++)
+        {
+            for (int target = 0; target < databaseCount; target++)
+            {
+                printScore(blockScores[(size_t)query * databaseCount + target], queryNames[query],
+                           databaseNames[target]);
+            }
+        }
+        for (int query = first; query < last; query++)
+        {
+            trackedFree(profiles[query].scores);
+            profiles[query].scores = NULL;
+        }
+        first = last;
+    }
+    free(queryLengths);
+    free(databaseLengths);
+    free(profiles);
+    trackedFree(blockScores);
+    if (failed)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeSequencesMemory(queryNames, queriesCount);
+        freeSequencesMemory(queries, queriesCount);
+        freeSequencesMemory(databaseNames, databaseCount);
+        freeSequencesMemory(database, databaseCount);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void *scoreDatabaseWorker(void *argument)
+{
+    DatabaseScoring *scoring = (DatabaseScoring *)argument;
+    int *rows = (int *)trackedMalloc(2 * ((size_t)scoring->maximalQueryLength + 1) * sizeof(int),
+                                     MEMORY_WORKSPACE);
+    if (rows == NULL)
+    {
+        __atomic_store_n(&scoring->failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    int target = 0;
+    while ((target = __atomic_fetch_add(&scoring->nextTarget, 1, __ATOMIC_RELAXED)) <
+           scoring->databaseCount && !__atomic_load_n(&scoring->failed, __ATOMIC_RELAXED))
+    {
+        for (int query = scoring->firstQuery; query < scoring->lastQuery; query++)
+        {
+            scoring->blockScores[(size_t)query * scoring->databaseCount + target] =
+                profileKernel(&scoring->profiles[query], scoring->database[target],
+                              scoring->databaseLengths[target], scoring->residueCodes,
+                              scoring->g, rows);
+        }
+    }
+    trackedFree(rows);
+    return NULL;
+}
+
+int selectProfileKernel(const char *isaName)
+{
+    if (isaName == NULL)
+    {
+        isaName = getenv(ISA_ENVIRONMENT_VARIABLE);
+    }
+    if (isaName == NULL)
+    {
+        int widest = PROFILE_KERNEL_VARIANTS_COUNT - 1;
+        while (widest > 0 && strcmp(PROFILE_KERNEL_VARIANTS[widest].name, DEFAULT_WIDEST_ISA) != 0)
+        {
+            widest--;
+        }
+        // without the default ceiling among the variants (not on x86), every variant is a choice
+        widest = widest > 0 ? widest : PROFILE_KERNEL_VARIANTS_COUNT - 1;
+        for (int variant = widest; variant >= 0; variant--)
+        {
+            if (isProfileKernelSupported(variant))
+            {
+                profileKernel = PROFILE_KERNEL_VARIANTS[variant].kernel;
+                profileEngine = ENGINE_FIRST_PROFILE + variant;
+                return 0;
+            }
+        }
+    }
+    for (int variant = 0; isaName != NULL && variant < PROFILE_KERNEL_VARIANTS_COUNT; variant++)
+    {
+        if (strcmp(isaName, PROFILE_KERNEL_VARIANTS[variant].name) == 0)
+        {
+            profileKernel = PROFILE_KERNEL_VARIANTS[variant].kernel;
+            profileEngine = ENGINE_FIRST_PROFILE + variant;
+            return isProfileKernelSupported(variant) ? 0 : -1;
+        }
+    }
+    return -1;
+}
+
+int checkWeightsTriple(const char *str, int triple[3])
+{
+    const char *start = str;
+    for (int i = 0; i < 3; i++)
+    {
+        char *end = NULL;
+        errno = 0;
+        long value = strtol(start, &end, DECIMAL_BASE);
+        char expected = i < 2 ? WEIGHTS_SEPARATOR : '\0';
+        if (end == start || errno != 0 || *end != expected)
+        {
+            return -1;
+        }
+        triple[i] = (int)value;
+        start = end + 1;
+    }
+    return 0;
+}
+
+int checkNumber(char *str, int *numberAddress)
+{
+    char *end = NULL;
+    *numberAddress = (int)strtol(str, &end, DECIMAL_BASE);
+    if ((*numberAddress == 0 && (errno != 0 || end == str)) || *end != '\0')
+    {
+        return -1;
+    }
+    return 0;
+}
+
+void readSequencesFile(char *fileName, char *sequencesNames[], char *sequences[],
+                       int *numberOfSequencesAddress)
+{
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening file\n");
+        exit(EXIT_FAILURE);
+    }
+    char row[MAXIMAL_ROW_LENGTH];
+    int startSequence = 0;
+    int rowLength = 0;
+    int sequenceLength = 0;
+    char *temp = NULL;
+    while(fgets(row, MAXIMAL_ROW_LENGTH, file) != NULL)
+    {
+        //when malloc add 1 to numberOfSequences
+        if (row[0] == HEADER_LINE_FIRST_CHAR)
+        {
+            rowLength = deleteNewline(row);
+            sequencesNames[*numberOfSequencesAddress] = (char *)trackedMalloc(
+                                                            rowLength * sizeof(char), MEMORY_NAMES);
+            if (sequencesNames[*numberOfSequencesAddress] == NULL)
+            {
+                fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+                freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
+                freeSequencesMemory(sequences, *numberOfSequencesAddress);
+                exit(EXIT_FAILURE);
+            }
+            else
+            {
+                strncpy(sequencesNames[*numberOfSequencesAddress], row + 1, (size_t)rowLength - 1);
+                sequencesNames[*numberOfSequencesAddress][rowLength - 1] = '\0';
+            }
+            startSequence = 1;
+        }
+        else
+        {
+            rowLength = deleteNewline(row);
+            if (startSequence)
+            {
+                sequences[*numberOfSequencesAddress] = (char *)trackedMalloc(
+                                                       (rowLength + 1) * sizeof(char),
+                                                       MEMORY_SEQUENCES);
+                if (sequences[*numberOfSequencesAddress] == NULL)
+                {
+                    fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+                    freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
+                    freeSequencesMemory(sequences, *numberOfSequencesAddress);
+                    exit(EXIT_FAILURE);
+                }
+                strncpy(sequences[*numberOfSequencesAddress], row, rowLength * sizeof(char));
+                sequences[*numberOfSequencesAddress][rowLength] = '\0';
+                (*numberOfSequencesAddress)++;
+                startSequence = 0;
+            }
+            else
+            {
+                sequenceLength = (int)strlen(sequences[*numberOfSequencesAddress - 1]);
+                temp = (char *)trackedRealloc(sequences[*numberOfSequencesAddress - 1],
+                        (sequenceLength + rowLength + 1) * sizeof(char), MEMORY_SEQUENCES);
+                if (temp == NULL)
+                {
+                    fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+                    freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
+                    freeSequencesMemory(sequences, *numberOfSequencesAddress);
+                    exit(EXIT_FAILURE);
+                }
+                sequences[*numberOfSequencesAddress - 1] = temp;
+                strncpy(sequences[*numberOfSequencesAddress - 1] + sequenceLength, row,
+                        rowLength * sizeof(char));
+                sequences[*numberOfSequencesAddress - 1][sequenceLength + rowLength] = '\0';
+            }
+        }
+    }
+    if (!feof(file))
+    {
+        fprintf(stderr, "Error reading file\n");
+        freeSequencesMemory(sequences, *numberOfSequencesAddress);
+        exit(EXIT_FAILURE);
+    }
+    if (fclose(file))
+    {
+        fprintf(stderr, "Error closing file\n");
+        freeSequencesMemory(sequences, *numberOfSequencesAddress);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int deleteNewline(char *row)
+{
+    int rowLength = 0;
+    for (int i = 0; i < MAXIMAL_ROW_LENGTH - 1; i++)
+    {
+        if (row[i] == '\n' || row[i] == '\r' || row[i] == EOF)
+        {
+            row[i] = '\0';
+            break;
+        }
+        rowLength++;
+    }
+    return rowLength;
+}
+
+void compareSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g, const ProgramOptions *options)
+{
+    ComparisonContext context;
+    long long scheduleStart = getTimeNanoseconds();
+    initializeComparisonContext(&context, sequencesNames, sequences, numberOfSequences, m, s, g,
+                                options);
+    if (options->sweepWeightsCount > 0)
+    {
+        compareSequencesSweep(&context);
+        freeComparisonContext(&context);
+        return;
+    }
+    long long indexStart = getTimeNanoseconds();
+    int seedsCount = 0;
+    int *sharedSeeds = NULL;
+    if (options->prefilter)
+    {
+        sharedSeeds = buildSeedIndex(sequencesNames, sequences, numberOfSequences, options,
+                                     &seedsCount);
+    }
+    long long indexTime = getTimeNanoseconds() - indexStart;
+    int keptPairs = 0, totalPairs = 0, relatedPairs = 0, keptRelatedPairs = 0;
+    long long keptCells = 0, totalCells = 0;
+    long long alignStart = getTimeNanoseconds();
+    findShardRange(&context);
+    long long shardPairs = 0, resumePair = -1;
+    int finished = 0;
+    if (options->checkpointPrefix != NULL)
+    {
+        finished = openCheckpoint(&context, &resumePair, &shardPairs);
+        if (finished < 0)
+        {
+            fprintf(stderr, "Error opening checkpoint files, or they belong to another run\n");
+            free(sharedSeeds);
+            freeComparisonContext(&context);
+            freeSequencesMemory(sequencesNames, numberOfSequences);
+            freeSequencesMemory(sequences, numberOfSequences);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (options->shardIndex > 0 && resumePair < 0 && !finished)
+    {
+        printf("%s %d %d %d %d %d %016llx %lld %lld %lld %d\n", SHARD_SIGNATURE,
+               options->shardIndex, options->shardsCount, m, s, g,
+               (unsigned long long)hashInput(&context), context.shardFirstPair,
+               context.shardEndPair,
+               getPairIndex(numberOfSequences, numberOfSequences - 2, numberOfSequences - 1) + 1,
+               getScoringMode(options));
+    }
+    // the pairs done before the checkpoint are left out of the run like another shard's pairs
+    if (finished)
+    {
+        fprintf(stderr, "Checkpoint: the run is already finished\n");
+        context.shardFirstPair = context.shardEndPair;
+    }
+    else if (resumePair > context.shardFirstPair)
+    {
+        fprintf(stderr, "Checkpoint: resuming from pair %lld\n", resumePair);
+        context.shardFirstPair = resumePair;
+    }
+    if (options->autoTune && !options->anchored)
+    {
+        planEngines(&context);
+    }
+    if (options->progress)
+    {
+        startProgress(&context, sharedSeeds);
+    }
+    context.phaseTimes[PHASE_PARSE] = options->parseTime;
+    PerfCounters counters;
+    if (options->perf)
+    {
+        // the counters are inherited by the worker threads, which are all created after this
+        if (openPerfCounters(&counters, 1) < PERF_COUNTERS_COUNT)
+        {
+            fprintf(stderr, "Perf: some hardware counters are not available (%s)\n",
+                    strerror(counters.error));
+        }
+        startPerfCounters(&counters);
+    }
+    long long mark = markPhase(&context, PHASE_SCHEDULE, scheduleStart);
+    if (options->tiled)
+    {
+        scorePairsTiled(&context, sharedSeeds);
+    }
+    else if (options->threads > 1)
+    {
+        scorePairsParallel(&context, sharedSeeds);
+    }
+    markPhase(&context, PHASE_ALIGN, mark);
+    for (int i = 0; i < numberOfSequences - 1; i++)
+    {
+        for (int j = i + 1; j < numberOfSequences; j++)
+        {
+            long long pairIndex = getPairIndex(numberOfSequences, i, j);
+            if (pairIndex < context.shardFirstPair || pairIndex >= context.shardEndPair)
+            {
+                continue;
+            }
+            if (context.journal != NULL && getTimeNanoseconds() - context.lastCheckpointTime >=
+                                           options->checkpointInterval * NANOSECONDS_IN_SECOND)
+            {
+                writeCheckpoint(&context, pairIndex, shardPairs);
+            }
+            if (sharedSeeds == NULL)
+            {
+                compareTwoSequences(&context, i, j);
+                shardPairs++;
+                continue;
+            }
+            int kept = isCandidatePair(sharedSeeds, numberOfSequences, i, j,
+                                       options->minimalSharedSeeds);
+            long long cells = (long long)context.lengths[i] * context.lengths[j];
+            totalPairs++;
+            totalCells += cells;
+            if (kept)
+            {
+                keptPairs++;
+                keptCells += cells;
+                compareTwoSequences(&context, i, j);
+                shardPairs++;
+            }
+            else if (context.pairStatistics != NULL)
+            {
+                context.pairStatistics[(size_t)i * numberOfSequences + j].source =
+                    PAIR_SOURCE_PRUNED;
+            }
+            if (!options->prefilterCheck)
+            {
+                continue;
+            }
+            // a kept pair was just scored exactly, unless the anchored scores are a lower bound
+            int exactScore = kept && !options->anchored ?
+                             context.pairScores[(size_t)i * numberOfSequences + j] :
+                             scoreTwoSequences(sequencesNames, sequences, numberOfSequences,
+                                               sequences[i], sequences[j], m, s, g);
+            if (exactScore >= options->prefilterCheckThreshold)
+            {
+                relatedPairs++;
+                keptRelatedPairs += kept;
+            }
+        }
+    }
+    long long alignTime = getTimeNanoseconds() - alignStart;
+    if (options->perf)
+    {
+        stopPerfCounters(&counters);
+        closePerfCounters(&counters);
+        long long comparedCells = 0;
+        for (int i = 0; i < numberOfSequences - 1; i++)
+        {
+            for (int j = i + 1; j < numberOfSequences; j++)
+            {
+                comparedCells += context.pairCompared[(size_t)i * numberOfSequences + j] ?
+                                 (long long)context.lengths[i] * context.lengths[j] : 0;
+            }
+        }
+        fprintf(stderr, "Perf: over %lld cells of the pairs compared, cycles/cell,IPC,"
+                "L1d misses/kcell,LLC misses/kcell,branch misses/kcell: ", comparedCells);
+        printPerfCounters(stderr, &counters, comparedCells);
+    }
+    if (context.progress != NULL)
+    {
+        stopProgress(&context);
+    }
+    if (options->shardIndex > 0 && !finished)
+    {
+        printf("%s %lld\n", SHARD_END, shardPairs);
+    }
+    if (options->statsFileName != NULL)
+    {
+        mark = markPhase(&context, PHASE_NONE, 0);
+        fflush(stdout);
+        markPhase(&context, PHASE_OUTPUT, mark);
+        if (writeStatistics(&context, options->statsFileName))
+        {
+            fprintf(stderr, "Error writing stats file\n");
+        }
+    }
+    if (context.journal != NULL && !finished)
+    {
+        closeCheckpoint(&context);
+    }
+    else if (context.journal != NULL)
+    {
+        fclose(context.journal);
+    }
+    if (options->previousMatrixFileName != NULL)
+    {
+        fprintf(stderr, "Incremental: %d pairs reused from the previous run\n",
+                context.reusedPairs);
+    }
+    if (options->matrixOutputFileName != NULL &&
+        writeResultsMatrix(&context, options->matrixOutputFileName))
+    {
+        fprintf(stderr, "Error writing matrix file (or a sequence name contains a tab)\n");
+    }
+    if (options->memoryLimit > 0)
+    {
+        fprintf(stderr, "Memory: limit %d MB, pairs by strategy:", options->memoryLimit);
+        for (int strategy = 0; strategy < STRATEGIES_COUNT; strategy++)
+        {
+            fprintf(stderr, "%s %s %d", strategy > 0 ? "," : "", STRATEGY_NAMES[strategy],
+                    context.strategyCounts[strategy]);
+        }
+        fprintf(stderr, "\n");
+    }
+    freeComparisonContext(&context);
+    if (sharedSeeds == NULL)
+    {
+        return;
+    }
+    free(sharedSeeds);
+    fprintf(stderr, "Prefilter: k = %d, w = %d, min-seeds = %d, %d minimizers indexed in %.3f ms\n",
+            options->kmerLength, options->windowLength, options->minimalSharedSeeds, seedsCount,
+            indexTime / NANOSECONDS_IN_MILLISECOND);
+    fprintf(stderr, "Prefilter: kept %d of %d pairs (%.1f%%), %lld of %lld cells (%.1f%%), "
+            "aligned in %.3f ms\n", keptPairs, totalPairs,
+            totalPairs ? PERCENT * keptPairs / totalPairs : PERCENT, keptCells, totalCells,
+            totalCells ? PERCENT * (double)keptCells / (double)totalCells : PERCENT,
+            alignTime / NANOSECONDS_IN_MILLISECOND);
+    if (options->prefilterCheck)
+    {
+        fprintf(stderr, "Prefilter: sensitivity %.1f%% (%d of %d pairs scoring at least %d)\n",
+                relatedPairs ? PERCENT * keptRelatedPairs / relatedPairs : PERCENT,
+                keptRelatedPairs, relatedPairs, options->prefilterCheckThreshold);
+    }
+}
+
+void compareSequencesSweep(ComparisonContext *context)
+{
+    int n = context->numberOfSequences, maximalLength = 0;
+    int triplesCount = context->options->sweepWeightsCount + 1;
+    for (int i = 0; i < n; i++)
+    {
+        maximalLength = context->lengths[i] > maximalLength ? context->lengths[i] : maximalLength;
+    }
+    size_t pairsCount = (size_t)n * (n - 1) / 2;
+    int *scores = (int *)malloc((pairsCount * triplesCount + 1) * sizeof(int));
+    // a vector type is aligned to its size, which malloc doesn't guarantee
+    void *row = NULL;
+    if (posix_memalign(&row, SWEEP_VECTOR_BYTES, (maximalLength + 1) * sizeof(SweepVector)))
+    {
+        row = NULL;
+    }
+    if (scores == NULL || row == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        free(scores);
+        free(row);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, n);
+        freeSequencesMemory(context->sequences, n);
+        exit(EXIT_FAILURE);
+    }
+    // unused lanes of the last group repeat the last triple, and their scores are dropped
+    for (int first = 0; first < triplesCount; first += SWEEP_LANES)
+    {
+        SweepVector weights[3], laneScores;
+        for (int lane = 0; lane < SWEEP_LANES; lane++)
+        {
+            int triple = first + lane < triplesCount ? first + lane : triplesCount - 1;
+            for (int weight = 0; weight < 3; weight++)
+            {
+                weights[weight][lane] = context->options->sweepWeights[triple][weight];
+            }
+        }
+        size_t pair = 0;
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++, pair++)
+            {
+                scoreSweepLanes(context->sequences[i], context->lengths[i],
+                                context->sequences[j], context->lengths[j], weights,
+                                (SweepVector *)row, &laneScores);
+                for (int lane = 0; lane < SWEEP_LANES && first + lane < triplesCount; lane++)
+                {
+                    scores[(size_t)(first + lane) * pairsCount + pair] = laneScores[lane];
+                }
+            }
+        }
+    }
+    for (int triple = 0; triple < triplesCount; triple++)
+    {
+        const int *weights = context->options->sweepWeights[triple];
+        printf("Weights: m = %d, s = %d, g = %d\n", weights[0], weights[1], weights[2]);
+        size_t pair = 0;
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++, pair++)
+            {
+                printScore(scores[(size_t)triple * pairsCount + pair], context->sequencesNames[i],
+                           context->sequencesNames[j]);
+            }
+        }
+    }
+    free(scores);
+    free(row);
+}
+
+void scoreSweepLanes(const char *sequence1, int length1, const char *sequence2, int length2,
+                     const SweepVector weights[3], SweepVector *row, SweepVector *scores)
+{
+    const SweepVector *m = &weights[0], *s = &weights[1], *g = &weights[2];
+    row[0] = *g - *g;
+    for (int j = 1; j <= length2; j++)
+    {
+        row[j] = row[j - 1] + *g;
+    }
+    for (int i = 0; i < length1; i++)
+    {
+        SweepVector diagonal = row[0];
+        row[0] += *g;
+        for (int j = 1; j <= length2; j++)
+        {
+            SweepVector up = row[j];
+            SweepVector score = diagonal + (sequence1[i] == sequence2[j - 1] ? *m : *s);
+            SweepVector left = row[j - 1] + *g;
+            up += *g;
+            maxSweepVector(&score, &left);
+            maxSweepVector(&score, &up);
+            diagonal = row[j];
+            row[j] = score;
+        }
+    }
+    *scores = row[length2];
+}
+
+void maxSweepVector(SweepVector *target, const SweepVector *other)
+{
+    SweepVector targetIsLarger = *target >= *other;
+    *target = (*target & targetIsLarger) | (*other & ~targetIsLarger);
+}
+
+void initializeComparisonContext(ComparisonContext *context, char *sequencesNames[],
+                                 char *sequences[], int numberOfSequences, int m, int s, int g,
+                                 const ProgramOptions *options)
+{
+    context->sequencesNames = sequencesNames;
+    context->sequences = sequences;
+    context->numberOfSequences = numberOfSequences;
+    context->m = m;
+    context->s = s;
+    context->g = g;
+    context->options = options;
+    size_t pairsCount = (size_t)numberOfSequences * numberOfSequences;
+    context->lengths = (int *)malloc((numberOfSequences + 1) * sizeof(int));
+    context->hashes = (uint64_t *)malloc((numberOfSequences + 1) * sizeof(uint64_t));
+    context->representatives = (int *)malloc((numberOfSequences + 1) * sizeof(int));
+    context->scores = (int *)trackedMalloc((pairsCount + 1) * sizeof(int), MEMORY_CACHES);
+    context->scoreKnown = (char *)trackedCalloc(pairsCount + 1, sizeof(char), MEMORY_CACHES);
+    context->cache = NULL;
+    char seen[ALPHABET_SIZE] = {0};
+    context->alphabetSize = 0;
+    memset(context->residueCodes, 0, sizeof(context->residueCodes));
+    context->pairScores = (int *)trackedMalloc((pairsCount + 1) * sizeof(int), MEMORY_OUTPUT);
+    context->pairCompared = (char *)trackedCalloc(pairsCount + 1, sizeof(char), MEMORY_OUTPUT);
+    context->previous = NULL;
+    context->previousIndices = NULL;
+    context->reusedPairs = 0;
+    pthread_mutex_init(&context->lock, NULL);
+    pthread_cond_init(&context->memoryReleased, NULL);
+    context->reservedMemory = 0;
+    context->activePairs = 0;
+    memset(context->strategyCounts, 0, sizeof(context->strategyCounts));
+    context->progress = NULL;
+    context->progressOnPrint = 1;
+    memset(context->phaseTimes, 0, sizeof(context->phaseTimes));
+    context->pairStatistics = NULL;
+    if (options->statsFileName != NULL)
+    {
+        context->pairStatistics = (PairStatistics *)calloc(pairsCount + 1,
+                                                           sizeof(PairStatistics));
+        if (context->pairStatistics == NULL)
+        {
+            fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+            freeComparisonContext(context);
+            freeSequencesMemory(sequencesNames, numberOfSequences);
+            freeSequencesMemory(sequences, numberOfSequences);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (context->lengths == NULL || context->hashes == NULL || context->representatives == NULL ||
+        context->scores == NULL || context->scoreKnown == NULL || context->pairScores == NULL ||
+        context->pairCompared == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeComparisonContext(context);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        context->lengths[i] = (int)strlen(sequences[i]);
+        context->hashes[i] = hashSequence(sequences[i], context->lengths[i]);
+        context->alphabetSize = addToAlphabet(sequences[i], context->lengths[i],
+                                              context->residueCodes, seen, context->alphabetSize);
+        context->representatives[i] = i;
+        for (int j = 0; j < i && !options->noDeduplication; j++)
+        {
+            // the hash only rules out pairs, equal hashes are confirmed by the content
+            if (context->representatives[j] == j && context->hashes[j] == context->hashes[i] &&
+                context->lengths[j] == context->lengths[i] &&
+                memcmp(sequences[j], sequences[i], (size_t)context->lengths[i]) == 0)
+            {
+                context->representatives[i] = j;
+                break;
+            }
+        }
+    }
+    if (options->cacheFileName != NULL)
+    {
+        context->cache = openScoreCache(options->cacheFileName, options->cacheCapacity);
+        if (context->cache == NULL)
+        {
+            fprintf(stderr, "Error opening cache file\n");
+            freeComparisonContext(context);
+            freeSequencesMemory(sequencesNames, numberOfSequences);
+            freeSequencesMemory(sequences, numberOfSequences);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (options->previousMatrixFileName != NULL &&
+        loadPreviousResults(context, options->previousMatrixFileName))
+    {
+        fprintf(stderr, "Error reading previous results file\n");
+        freeComparisonContext(context);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void freeComparisonContext(ComparisonContext *context)
+{
+    if (context->cache != NULL)
+    {
+        fprintf(stderr, "Cache: %d hits, %d misses\n", context->cache->hits,
+                context->cache->misses);
+        closeScoreCache(context->cache);
+        context->cache = NULL;
+    }
+    free(context->lengths);
+    free(context->hashes);
+    free(context->representatives);
+    trackedFree(context->scores);
+    trackedFree(context->scoreKnown);
+    trackedFree(context->pairScores);
+    trackedFree(context->pairCompared);
+    free(context->previousIndices);
+    free(context->pairStatistics);
+    freePreviousResults(context->previous);
+    context->pairStatistics = NULL;
+    context->pairScores = NULL;
+    context->pairCompared = NULL;
+    context->previousIndices = NULL;
+    context->previous = NULL;
+    context->lengths = NULL;
+    context->hashes = NULL;
+    context->representatives = NULL;
+    context->scores = NULL;
+    context->scoreKnown = NULL;
+}
+
+uint64_t hashSequence(const char *sequence, int length)
+{
+    uint64_t accumulator = SEQUENCE_HASH_SEED + (uint64_t)length * SEQUENCE_HASH_PRIME1;
+    int i = 0;
+    for (; i + (int)sizeof(uint64_t) <= length; i += (int)sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, sequence + i, sizeof(word));
+        word = rotateLeft(word * SEQUENCE_HASH_PRIME2, SEQUENCE_HASH_WORD_ROTATION);
+        accumulator ^= word * SEQUENCE_HASH_PRIME1;
+        accumulator = rotateLeft(accumulator, SEQUENCE_HASH_ACCUMULATOR_ROTATION) *
+                      SEQUENCE_HASH_PRIME1;
+    }
+    for (; i < length; i++)
+    {
+        accumulator ^= (unsigned char)sequence[i] * SEQUENCE_HASH_PRIME2;
+        accumulator = rotateLeft(accumulator, SEQUENCE_HASH_BYTE_ROTATION) * SEQUENCE_HASH_PRIME1;
+    }
+    return mixHash(accumulator);
+}
+
+uint64_t rotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (BITS_IN_WORD - bits));
+}
+
+int scorePair(ComparisonContext *context, int first, int second)
+{
+    int score = 0;
+    pthread_mutex_lock(&context->lock);
+    int found = findPairScore(context, first, second, &score);
+    pthread_mutex_unlock(&context->lock);
+    if (!found)
+    {
+        long long start = context->pairStatistics != NULL ? getTimeNanoseconds() : 0;
+        long long traceBegin = beginTrace();
+        score = alignPair(context, context->representatives[first],
+                          context->representatives[second]);
+        endTrace("align", traceBegin, first, second);
+        if (threadSlot > 0 && __atomic_load_n(&workerFailed, __ATOMIC_RELAXED))
+        {
+            return 0;
+        }
+        if (context->pairStatistics != NULL)
+        {
+            recordPairStatistics(context, first, second, getTimeNanoseconds() - start, NULL);
+        }
+        countProgress(context, 0, 0, (long long)context->lengths[first] * context->lengths[second]);
+        pthread_mutex_lock(&context->lock);
+        storePairScore(context, first, second, score);
+        pthread_mutex_unlock(&context->lock);
+    }
+    return score;
+}
+
+int findPairScore(ComparisonContext *context, int first, int second, int *scoreAddress)
+{
+    if (isReusedPair(context, first, second))
+    {
+        size_t previousCount = (size_t)context->previous->numberOfSequences;
+        size_t previousKey = context->previousIndices[first] * previousCount +
+                             context->previousIndices[second];
+        *scoreAddress = context->previous->scores[previousKey];
+        return 1;
+    }
+    int representative1 = context->representatives[first];
+    int representative2 = context->representatives[second];
+    // aligning every residue to its copy is optimal when a match beats a mismatch and two gaps
+    if (representative1 == representative2 && context->m >= context->s &&
+        context->m >= 2 * context->g)
+    {
+        *scoreAddress = context->lengths[first] * context->m;
+        return 1;
+    }
+    size_t key = (size_t)representative1 * context->numberOfSequences + representative2;
+    if (!context->scoreKnown[key] && context->cache != NULL)
+    {
+        ScoreCacheEntry cacheKey;
+        makeScoreCacheKey(context, representative1, representative2, &cacheKey);
+        context->scoreKnown[key] = (char)lookupScoreCache(context->cache, &cacheKey,
+                                                          &context->scores[key]);
+    }
+    if (context->scoreKnown[key])
+    {
+        *scoreAddress = context->scores[key];
+        return 1;
+    }
+    return 0;
+}
+
+int isReusedPair(const ComparisonContext *context, int first, int second)
+{
+    if (context->previous == NULL)
+    {
+        return 0;
+    }
+    int previous1 = context->previousIndices[first];
+    int previous2 = context->previousIndices[second];
+    size_t previousKey = (size_t)previous1 * context->previous->numberOfSequences + previous2;
+    return previous1 >= 0 && previous2 >= 0 && context->previous->scoreKnown[previousKey];
+}
+
+void storePairScore(ComparisonContext *context, int first, int second, int score)
+{
+    int representative1 = context->representatives[first];
+    int representative2 = context->representatives[second];
+    size_t key = (size_t)representative1 * context->numberOfSequences + representative2;
+    context->scores[key] = score;
+    context->scoreKnown[key] = 1;
+    if (context->cache != NULL)
+    {
+        ScoreCacheEntry cacheKey;
+        makeScoreCacheKey(context, representative1, representative2, &cacheKey);
+        storeScoreCache(context->cache, &cacheKey, score);
+    }
+}
+
+int isScheduledPair(const ComparisonContext *context, const int *sharedSeeds, int first,
+                    int second)
+{
+    long long pairIndex = getPairIndex(context->numberOfSequences, first, second);
+    return pairIndex >= context->shardFirstPair && pairIndex < context->shardEndPair &&
+           isCandidatePair(sharedSeeds, context->numberOfSequences, first, second,
+                           context->options->minimalSharedSeeds);
+}
+
+long long getPairIndex(int numberOfSequences, int first, int second)
+{
+    return (long long)first * (2 * numberOfSequences - first - 1) / 2 + (second - first - 1);
+}
+
+void findShardRange(ComparisonContext *context)
+{
+    int n = context->numberOfSequences;
+    int shard = context->options->shardIndex - 1, shardsCount = context->options->shardsCount;
+    context->shardFirstPair = 0;
+    context->shardEndPair = getPairIndex(n, n - 2, n - 1) + 1;
+    context->journal = NULL;
+    context->pairsJournaled = 0;
+    if (shard < 0)
+    {
+        return;
+    }
+    long long totalCost = 0;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            totalCost += (long long)context->lengths[i] * context->lengths[j] + 1;
+        }
+    }
+    // a pair belongs to the shard its cost starts in
+    long long cost = 0, pairIndex = 0, firstPair = -1, endPair = -1;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++, pairIndex++)
+        {
+            // the cost times the shards count can overflow 64 bits on large inputs
+            long long pairShard = (long long)((__int128)cost * shardsCount / totalCost);
+            if (pairShard == shard && firstPair < 0)
+            {
+                firstPair = pairIndex;
+            }
+            if (pairShard > shard && endPair < 0)
+            {
+                endPair = pairIndex;
+            }
+            cost += (long long)context->lengths[i] * context->lengths[j] + 1;
+        }
+    }
+    context->shardEndPair = endPair < 0 ? pairIndex : endPair;
+    context->shardFirstPair = firstPair < 0 ? context->shardEndPair : firstPair;
+}
+
+uint64_t hashInput(const ComparisonContext *context)
+{
+    uint64_t hash = SEQUENCE_HASH_SEED;
+    for (int i = 0; i < context->numberOfSequences; i++)
+    {
+        const char *name = context->sequencesNames[i];
+        hash = rotateLeft(hash ^ hashSequence(name, (int)strlen(name)),
+                          SEQUENCE_HASH_ACCUMULATOR_ROTATION) * SEQUENCE_HASH_PRIME1;
+        hash = rotateLeft(hash ^ context->hashes[i], SEQUENCE_HASH_ACCUMULATOR_ROTATION) *
+               SEQUENCE_HASH_PRIME1;
+    }
+    return hash;
+}
+
+int mergeShards(int filesCount, char *fileNames[])
+{
+    if (filesCount < 1)
+    {
+        return -1;
+    }
+    long long (*headers)[SHARD_HEADER_FIELDS - 1] =
+        (long long (*)[SHARD_HEADER_FIELDS - 1])malloc(filesCount * sizeof(*headers));
+    int *order = (int *)malloc(filesCount * sizeof(int));
+    char *buffer = (char *)malloc(MERGE_BUFFER_BYTES);
+    int failed = headers == NULL || order == NULL || buffer == NULL;
+    for (int i = 0; !failed && i < filesCount; i++)
+    {
+        FILE *file = fopen(fileNames[i], "r");
+        failed = file == NULL || readShardHeader(file, headers[i]);
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+    }
+    // every shard of the same run must be present exactly once
+    int shardsCount = failed ? 0 : (int)headers[0][SHARD_FIELD_COUNT];
+    failed = failed || shardsCount != filesCount;
+    for (int i = 0; !failed && i < filesCount; i++)
+    {
+        order[i] = -1;
+    }
+    for (int i = 0; !failed && i < filesCount; i++)
+    {
+        int shard = (int)headers[i][SHARD_FIELD_INDEX] - 1;
+        for (int field = SHARD_FIELD_COUNT; !failed && field < SHARD_HEADER_FIELDS - 1; field++)
+        {
+            // the shard's own range is checked against its neighbours below
+            failed = field != SHARD_FIELD_FIRST_PAIR && field != SHARD_FIELD_END_PAIR &&
+                     headers[i][field] != headers[0][field];
+        }
+        failed = failed || shard < 0 || shard >= shardsCount || order[shard] >= 0;
+        if (!failed)
+        {
+            order[shard] = i;
+        }
+    }
+    long long nextPair = 0;
+    for (int shard = 0; !failed && shard < shardsCount; shard++)
+    {
+        failed = headers[order[shard]][SHARD_FIELD_FIRST_PAIR] != nextPair;
+        nextPair = headers[order[shard]][SHARD_FIELD_END_PAIR];
+    }
+    failed = failed || nextPair != headers[0][SHARD_FIELD_PAIRS];
+    for (int shard = 0; !failed && shard < shardsCount; shard++)
+    {
+        // the lines between the header and the end marker are the shard's part of the output
+        FILE *file = fopen(fileNames[order[shard]], "r");
+        failed = file == NULL;
+        while (!failed && fgets(buffer, MERGE_BUFFER_BYTES, file) != NULL)
+        {
+            if (strncmp(buffer, SHARD_SIGNATURE, strlen(SHARD_SIGNATURE)) != 0 &&
+                strncmp(buffer, SHARD_END, strlen(SHARD_END)) != 0)
+            {
+                fputs(buffer, stdout);
+            }
+        }
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+    }
+    free(headers);
+    free(order);
+    free(buffer);
+    return failed ? -1 : 0;
+}
+
+int readShardHeader(FILE *file, long long header[SHARD_HEADER_FIELDS - 1])
+{
+    char signature[sizeof(SHARD_SIGNATURE) + 1];
+    unsigned long long hash = 0;
+    if (fscanf(file, "%11s %lld %lld %lld %lld %lld %llx %lld %lld %lld %lld", signature,
+               &header[0], &header[1], &header[2], &header[3], &header[4], &hash, &header[6],
+               &header[7], &header[8], &header[9]) != SHARD_HEADER_FIELDS ||
+        strcmp(signature, SHARD_SIGNATURE) != 0)
+    {
+        return -1;
+    }
+    header[SHARD_FIELD_HASH] = (long long)hash;
+    char line[MERGE_BUFFER_BYTES];
+    int ended = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (ended)
+        {
+            return -1;
+        }
+        ended = strncmp(line, SHARD_END, strlen(SHARD_END)) == 0;
+    }
+    return ended ? 0 : -1;
+}
+
+int openCheckpoint(ComparisonContext *context, long long *resumePairAddress,
+                   long long *printedPairsAddress)
+{
+    const ProgramOptions *options = context->options;
+    size_t pathLength = strlen(options->checkpointPrefix) + strlen(CHECKPOINT_JOURNAL_SUFFIX) + 1;
+    char *outputPath = (char *)malloc(pathLength), *journalPath = (char *)malloc(pathLength);
+    if (outputPath == NULL || journalPath == NULL)
+    {
+        free(outputPath);
+        free(journalPath);
+        return -1;
+    }
+    snprintf(outputPath, pathLength, "%s%s", options->checkpointPrefix, CHECKPOINT_OUTPUT_SUFFIX);
+    snprintf(journalPath, pathLength, "%s%s", options->checkpointPrefix,
+             CHECKPOINT_JOURNAL_SUFFIX);
+    char signature[JOURNAL_LINE_LENGTH];
+    snprintf(signature, sizeof(signature), "%s %d %d %d %016llx %lld %lld %d\n",
+             JOURNAL_SIGNATURE, context->m, context->s, context->g,
+             (unsigned long long)hashInput(context), context->shardFirstPair,
+             context->shardEndPair, getScoringMode(options));
+    long long outputBytes = 0;
+    int result = 0;
+    *resumePairAddress = -1;
+    *printedPairsAddress = 0;
+    // resuming a run that never journaled anything starts it afresh
+    int resume = options->resume && access(journalPath, F_OK) == 0;
+    context->journal = fopen(journalPath, resume ? "r+" : "w");
+    if (context->journal != NULL && resume)
+    {
+        // the last complete record wins, a record cut by the kill is ignored
+        char line[JOURNAL_LINE_LENGTH];
+        result = fgets(line, sizeof(line), context->journal) == NULL ||
+                 strcmp(line, signature) != 0 ? -1 : 0;
+        while (result == 0 && fgets(line, sizeof(line), context->journal) != NULL)
+        {
+            long long nextPair = 0, bytes = 0, printedPairs = 0;
+            if (strcmp(line, JOURNAL_FINISHED "\n") == 0)
+            {
+                result = 1;
+            }
+            else if (line[strlen(line) - 1] == '\n' &&
+                     sscanf(line, "%lld %lld %lld", &nextPair, &bytes, &printedPairs) == 3)
+            {
+                *resumePairAddress = nextPair;
+                outputBytes = bytes;
+                *printedPairsAddress = printedPairs;
+            }
+        }
+        // the scores are read in a second pass, once the pairs printed before the checkpoint are
+        // known
+        long long printedEnd = result == 1 ? context->shardEndPair : *resumePairAddress;
+        int n = context->numberOfSequences;
+        rewind(context->journal);
+        while (result >= 0 && fgets(line, sizeof(line), context->journal) != NULL)
+        {
+            int first = 0, second = 0, score = 0;
+            char end = 0;
+            if (sscanf(line, JOURNAL_SCORE " %d %d %d%c", &first, &second, &score, &end) != 4 ||
+                end != '\n' || first < 0 || first >= second || second >= n)
+            {
+                continue;
+            }
+            storePairScore(context, first, second, score);
+            size_t key = (size_t)first * n + second;
+            if (getPairIndex(n, first, second) < printedEnd)
+            {
+                context->pairScores[key] = score;
+                context->pairCompared[key] = 1;
+            }
+            if (getPairIndex(n, first, second) < printedEnd && context->pairStatistics != NULL)
+            {
+                context->pairStatistics[key].source = PAIR_SOURCE_MEMO;
+            }
+        }
+        fseek(context->journal, 0, SEEK_END);
+    }
+    else if (context->journal != NULL)
+    {
+        fputs(signature, context->journal);
+    }
+    if (context->journal == NULL || result < 0 ||
+        freopen(outputPath, resume ? "r+" : "w", stdout) == NULL ||
+        (result == 0 && ftruncate(fileno(stdout), (off_t)outputBytes) != 0) ||
+        fseeko(stdout, 0, SEEK_END) != 0)
+    {
+        result = -1;
+    }
+    free(outputPath);
+    free(journalPath);
+    context->lastCheckpointTime = getTimeNanoseconds();
+    return result;
+}
+
+void writeCheckpoint(ComparisonContext *context, long long nextPair, long long printedPairs)
+{
+    long long traceBegin = beginTrace();
+    fflush(stdout);
+    fsync(fileno(stdout));
+    endTrace("output flush", traceBegin, -1, -1);
+    fprintf(context->journal, "%lld %lld %lld\n", nextPair, (long long)ftello(stdout),
+            printedPairs);
+    fflush(context->journal);
+    fsync(fileno(context->journal));
+    context->lastCheckpointTime = getTimeNanoseconds();
+}
+
+void journalPairScore(ComparisonContext *context, int first, int second, int score, int sync)
+{
+    if (context->journal == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&context->lock);
+    fprintf(context->journal, JOURNAL_SCORE " %d %d %d\n", first, second, score);
+    if (sync && getTimeNanoseconds() - context->lastCheckpointTime >=
+                context->options->checkpointInterval * NANOSECONDS_IN_SECOND)
+    {
+        long long traceBegin = beginTrace();
+        fflush(context->journal);
+        fsync(fileno(context->journal));
+        endTrace("journal flush", traceBegin, -1, -1);
+        context->lastCheckpointTime = getTimeNanoseconds();
+    }
+    pthread_mutex_unlock(&context->lock);
+}
+
+void closeCheckpoint(ComparisonContext *context)
+{
+    fflush(stdout);
+    fsync(fileno(stdout));
+    fputs(JOURNAL_FINISHED "\n", context->journal);
+    fflush(context->journal);
+    fsync(fileno(context->journal));
+    fclose(context->journal);
+    context->journal = NULL;
+}
+
+int isCandidatePair(const int *sharedSeeds, int numberOfSequences, int first, int second,
+                    int minimalSharedSeeds)
+{
+    if (sharedSeeds == NULL)
+    {
+        return 1;
+    }
+    int shared = sharedSeeds[first * numberOfSequences + second];
+    // a pair with a too short sequence can't be rejected by its seeds
+    return shared < 0 || shared >= minimalSharedSeeds;
+}
+
+void scorePairsTiled(ComparisonContext *context, const int *sharedSeeds)
+{
+    int n = context->numberOfSequences, alphabetSize = 0, maximalLength = 0;
+    unsigned char residueCodes[ALPHABET_SIZE] = {0};
+    char seen[ALPHABET_SIZE] = {0};
+    SequenceLength *order = (SequenceLength *)malloc((n + 1) * sizeof(SequenceLength));
+    int *blockStarts = (int *)malloc((n + 2) * sizeof(int));
+    // a panel and a block take at least one sequence each, so there are at most n * n tiles
+    int (*tiles)[3] = (int (*)[3])malloc(((size_t)n * n + 1) * sizeof(int[3]));
+    int failed = order == NULL || blockStarts == NULL || tiles == NULL;
+    char kernelName[MAXIMAL_ENGINE_NAME_LENGTH];
+    getEngineName(profileEngine, kernelName);
+    for (int i = 0; !failed && i < n; i++)
+    {
+        order[i].length = context->lengths[i];
+        order[i].index = i;
+        alphabetSize = addToAlphabet(context->sequences[i], context->lengths[i], residueCodes,
+                                     seen, alphabetSize);
+        maximalLength = context->lengths[i] > maximalLength ? context->lengths[i] : maximalLength;
+    }
+    int blocksCount = 0, tilesCount = 0;
+    if (!failed)
+    {
+        // similar lengths in a block give its pairs similar costs
+        qsort(order, (size_t)n, sizeof(SequenceLength), compareSequenceLengths);
+        size_t blockBytes = 0;
+        for (int i = 0; i < n; i++)
+        {
+            size_t bytes = (size_t)order[i].length * (1 + alphabetSize * sizeof(int)) +
+                           (order[i].length + 1) * sizeof(int);
+            if (i == 0 || blockBytes + bytes > TILE_L2_BYTES)
+            {
+                blockStarts[blocksCount++] = i;
+                blockBytes = 0;
+            }
+            blockBytes += bytes;
+        }
+        blockStarts[blocksCount] = n;
+    }
+    for (int panelStart = 0; !failed && panelStart < blocksCount;)
+    {
+        int panelEnd = panelStart;
+        size_t panelBytes = 0;
+        do
+        {
+            for (int i = blockStarts[panelEnd]; i < blockStarts[panelEnd + 1]; i++)
+            {
+                panelBytes += (size_t)order[i].length;
+            }
+            panelEnd++;
+        } while (panelEnd < blocksCount && panelBytes < TILE_L3_BYTES);
+        for (int block = 0; block < panelEnd; block++)
+        {
+            tiles[tilesCount][0] = block;
+            tiles[tilesCount][1] = panelStart;
+            tiles[tilesCount++][2] = panelEnd;
+        }
+        panelStart = panelEnd;
+    }
+    TiledScoring scoring;
+    scoring.context = context;
+    scoring.sharedSeeds = sharedSeeds;
+    scoring.order = order;
+    scoring.blockStarts = blockStarts;
+    scoring.tiles = tiles;
+    scoring.tilesCount = tilesCount;
+    scoring.nextTile = 0;
+    scoring.threadsStarted = 0;
+    scoring.workerThreads = context->options->threads > 1;
+    scoring.residueCodes = residueCodes;
+    scoring.alphabetSize = alphabetSize;
+    scoring.maximalLength = maximalLength;
+    scoring.kernelName = kernelName;
+    scoring.failed = failed;
+    pthread_t threads[MAXIMAL_THREADS];
+    int threadsCount = 0;
+    while (!failed && scoring.workerThreads && threadsCount < context->options->threads &&
+           pthread_create(&threads[threadsCount], NULL, scoreTilesWorker, &scoring) == 0)
+    {
+        threadsCount++;
+    }
+    // the main thread scores the tiles itself on a single thread, or if no thread started
+    if (!failed && threadsCount == 0)
+    {
+        scoring.workerThreads = 0;
+        scoreTilesWorker(&scoring);
+    }
+    for (int thread = 0; thread < threadsCount; thread++)
+    {
+        pthread_join(threads[thread], NULL);
+    }
+    free(order);
+    free(blockStarts);
+    free(tiles);
+    context->pairsJournaled = 1;
+    if (scoring.failed)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, n);
+        freeSequencesMemory(context->sequences, n);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void *scoreTilesWorker(void *argument)
+{
+    TiledScoring *scoring = (TiledScoring *)argument;
+    ComparisonContext *context = scoring->context;
+    if (scoring->workerThreads)
+    {
+        pthread_mutex_lock(&context->lock);
+        // the worker threads take the slots after the main thread's, in the order they start
+        threadSlot = ++scoring->threadsStarted;
+        pthread_mutex_unlock(&context->lock);
+    }
+    int n = context->numberOfSequences;
+    QueryProfile *profiles = (QueryProfile *)calloc((size_t)n + 1, sizeof(QueryProfile));
+    int *row = (int *)trackedMalloc(2 * ((size_t)scoring->maximalLength + 1) * sizeof(int),
+                                    MEMORY_WORKSPACE);
+    int failed = profiles == NULL || row == NULL;
+    while (!failed && !__atomic_load_n(&scoring->failed, __ATOMIC_RELAXED))
+    {
+        long long waitBegin = beginTrace();
+        pthread_mutex_lock(&context->lock);
+        int tile = scoring->nextTile < scoring->tilesCount ? scoring->nextTile++ : -1;
+        pthread_mutex_unlock(&context->lock);
+        endTrace("queue wait", waitBegin, -1, -1);
+        if (tile < 0)
+        {
+            break;
+        }
+        failed = scoreTile(scoring, tile, profiles, row);
+    }
+    if (failed)
+    {
+        __atomic_store_n(&scoring->failed, 1, __ATOMIC_RELAXED);
+    }
+    free(profiles);
+    trackedFree(row);
+    return NULL;
+}
+
+int scoreTile(TiledScoring *scoring, int tile, QueryProfile *profiles, int *row)
+{
+    ComparisonContext *context = scoring->context;
+    const SequenceLength *order = scoring->order;
+    const int *blockStarts = scoring->blockStarts;
+    int block = scoring->tiles[tile][0];
+    int panelStart = scoring->tiles[tile][1], panelEnd = scoring->tiles[tile][2];
+    int failed = 0;
+    for (int i = blockStarts[block]; !failed && i < blockStarts[block + 1]; i++)
+    {
+        profiles[i].length = order[i].length;
+        profiles[i].scores = (int *)trackedMalloc(
+            ((size_t)scoring->alphabetSize * order[i].length + 1) * sizeof(int), MEMORY_WORKSPACE);
+        failed = profiles[i].scores == NULL;
+        if (!failed)
+        {
+            buildQueryProfile(context->sequences[order[i].index], order[i].length,
+                              scoring->residueCodes, scoring->alphabetSize, context->m,
+                              context->s, &profiles[i]);
+        }
+    }
+    int firstTarget = blockStarts[block > panelStart ? block : panelStart];
+    for (int target = firstTarget; !failed && target < blockStarts[panelEnd]; target++)
+    {
+        int second = order[target].index;
+        int lastQuery = target < blockStarts[block + 1] ? target : blockStarts[block + 1];
+        for (int query = blockStarts[block]; query < lastQuery; query++)
+        {
+            int first = order[query].index < second ? order[query].index : second;
+            int last = order[query].index < second ? second : order[query].index;
+            int score = 0;
+            if (!isScheduledPair(context, scoring->sharedSeeds, first, last))
+            {
+                continue;
+            }
+            long long cells = (long long)context->lengths[first] * context->lengths[last];
+            pthread_mutex_lock(&context->lock);
+            int found = findPairScore(context, first, last, &score);
+            pthread_mutex_unlock(&context->lock);
+            if (!found)
+            {
+                long long start = markPhase(context, PHASE_NONE, 0);
+                long long traceBegin = beginTrace();
+                score = profileKernel(&profiles[query], context->sequences[second],
+                                      order[target].length, scoring->residueCodes, context->g,
+                                      row);
+                endTrace("align", traceBegin, first, last);
+                if (context->pairStatistics != NULL)
+                {
+                    recordPairStatistics(context, first, last, getTimeNanoseconds() - start,
+                                         scoring->kernelName);
+                }
+                pthread_mutex_lock(&context->lock);
+                storePairScore(context, first, last, score);
+                pthread_mutex_unlock(&context->lock);
+                countProgress(context, 0, 0, cells);
+            }
+            journalPairScore(context, first, last, score, 1);
+            countProgress(context, 1, cells, 0);
+        }
+    }
+    for (int i = blockStarts[block]; i < blockStarts[block + 1]; i++)
+    {
+        trackedFree(profiles[i].scores);
+        profiles[i].scores = NULL;
+    }
+    return failed ? -1 : 0;
+}
+
+int addToAlphabet(const char *sequence, int length, unsigned char *residueCodes, char *seen,
+                  int alphabetSize)
+{
+    for (int j = 0; j < length; j++)
+    {
+        unsigned char residue = (unsigned char)sequence[j];
+        if (!seen[residue])
+        {
+            seen[residue] = 1;
+            residueCodes[residue] = (unsigned char)alphabetSize++;
+        }
+    }
+    return alphabetSize;
+}
+
+int compareSequenceLengths(const void *first, const void *second)
+{
+    const SequenceLength *firstLength = (const SequenceLength *)first;
+    const SequenceLength *secondLength = (const SequenceLength *)second;
+    if (firstLength->length != secondLength->length)
+    {
+        return firstLength->length - secondLength->length;
+    }
+    return firstLength->index - secondLength->index;
+}
+
+int getScoringMode(const ProgramOptions *options)
+{
+    return options->anchored ? options->kmerLength : 0;
+}
+
+int loadPreviousResults(ComparisonContext *context, const char *fileName)
+{
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    PreviousResults *previous = (PreviousResults *)calloc(1, sizeof(PreviousResults));
+    int maximalFields = MAXIMAL_NUMBER_OF_SEQUENCES + 1;
+    char **fields = (char **)malloc(maximalFields * sizeof(char *));
+    context->previousIndices = (int *)malloc((context->numberOfSequences + 1) * sizeof(int));
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    int valid = previous != NULL && fields != NULL && context->previousIndices != NULL;
+    context->previous = previous;
+    // the signature line holds the weights and the scoring mode the scores were computed with
+    int m = 0, s = 0, g = 0, mode = 0;
+    valid = valid && getline(&line, &lineCapacity, file) > 0 &&
+            splitTabs(line, fields, maximalFields) == MATRIX_HEADER_FIELDS &&
+            strcmp(fields[0], MATRIX_SIGNATURE) == 0 && !checkNumber(fields[1], &m) &&
+            !checkNumber(fields[2], &s) && !checkNumber(fields[3], &g) &&
+            !checkNumber(fields[4], &mode) && m == context->m && s == context->s &&
+            g == context->g && mode == getScoringMode(context->options);
+    int count = 0;
+    valid = valid && getline(&line, &lineCapacity, file) > 0 &&
+            (count = splitTabs(line, fields, maximalFields) - 1) >= 0 &&
+            strcmp(fields[0], MATRIX_HASHES_TITLE) == 0;
+    if (valid)
+    {
+        previous->numberOfSequences = count;
+        previous->names = (char **)calloc((size_t)count + 1, sizeof(char *));
+        previous->hashes = (uint64_t *)malloc(((size_t)count + 1) * sizeof(uint64_t));
+        previous->scores = (int *)trackedMalloc(((size_t)count * count + 1) * sizeof(int),
+                                                MEMORY_CACHES);
+        previous->scoreKnown = (char *)trackedCalloc((size_t)count * count + 1, sizeof(char),
+                                                     MEMORY_CACHES);
+        valid = previous->names != NULL && previous->hashes != NULL &&
+                previous->scores != NULL && previous->scoreKnown != NULL;
+    }
+    for (int i = 0; valid && i < count; i++)
+    {
+        char *end = NULL;
+        previous->hashes[i] = (uint64_t)strtoull(fields[i + 1], &end, HEXADECIMAL_BASE);
+        valid = end != fields[i + 1] && *end == '\0';
+    }
+    valid = valid && getline(&line, &lineCapacity, file) > 0 &&
+            splitTabs(line, fields, maximalFields) == count + 1;
+    for (int i = 0; valid && i < count; i++)
+    {
+        previous->names[i] = (char *)trackedMalloc(strlen(fields[i + 1]) + 1, MEMORY_NAMES);
+        valid = previous->names[i] != NULL;
+        if (valid)
+        {
+            strcpy(previous->names[i], fields[i + 1]);
+        }
+    }
+    for (int i = 0; valid && i < count; i++)
+    {
+        valid = getline(&line, &lineCapacity, file) > 0 &&
+                splitTabs(line, fields, maximalFields) == count + 1;
+        for (int j = 0; valid && j < count; j++)
+        {
+            size_t key = (size_t)i * count + j;
+            if (strcmp(fields[j + 1], MATRIX_MISSING_SCORE) == 0 ||
+                strcmp(fields[j + 1], MATRIX_DIAGONAL) == 0)
+            {
+                continue;
+            }
+            valid = !checkNumber(fields[j + 1], &previous->scores[key]);
+            previous->scoreKnown[key] = 1;
+        }
+    }
+    free(line);
+    free(fields);
+    fclose(file);
+    if (!valid)
+    {
+        return -1;
+    }
+    int newSequences = 0;
+    for (int i = 0; i < context->numberOfSequences; i++)
+    {
+        context->previousIndices[i] = -1;
+        for (int j = 0; j < count; j++)
+        {
+            if (previous->hashes[j] == context->hashes[i] &&
+                strcmp(previous->names[j], context->sequencesNames[i]) == 0)
+            {
+                context->previousIndices[i] = j;
+                break;
+            }
+        }
+        newSequences += context->previousIndices[i] < 0;
+    }
+    fprintf(stderr, "Incremental: %d sequences in the previous run, %d new sequences\n", count,
+            newSequences);
+    return 0;
+}
+
+void freePreviousResults(PreviousResults *previous)
+{
+    if (previous == NULL)
+    {
+        return;
+    }
+    if (previous->names != NULL)
+    {
+        freeSequencesMemory(previous->names, previous->numberOfSequences);
+    }
+    free(previous->names);
+    free(previous->hashes);
+    trackedFree(previous->scores);
+    trackedFree(previous->scoreKnown);
+    free(previous);
+}
+
+int splitTabs(char *line, char **fields, int maximalFields)
+{
+    line[strcspn(line, "\r\n")] = '\0';
+    int count = 0;
+    char *field = line;
+    while (1)
+    {
+        if (count == maximalFields)
+        {
+            return -1;
+        }
+        fields[count++] = field;
+        char *tab = strchr(field, '\t');
+        if (tab == NULL)
+        {
+            return count;
+        }
+        *tab = '\0';
+        field = tab + 1;
+    }
+}
+
+int writeResultsMatrix(const ComparisonContext *context, const char *fileName)
+{
+    int n = context->numberOfSequences;
+    for (int i = 0; i < n; i++)
+    {
+        if (strchr(context->sequencesNames[i], '\t') != NULL)
+        {
+            return -1;
+        }
+    }
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    fprintf(file, "%s\t%d\t%d\t%d\t%d\n", MATRIX_SIGNATURE, context->m, context->s, context->g,
+            getScoringMode(context->options));
+    fprintf(file, "%s", MATRIX_HASHES_TITLE);
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(file, "\t%016llx", (unsigned long long)context->hashes[i]);
+    }
+    fprintf(file, "\n");
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(file, "\t%s", context->sequencesNames[i]);
+    }
+    fprintf(file, "\n");
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(file, "%s", context->sequencesNames[i]);
+        for (int j = 0; j < n; j++)
+        {
+            // every pair is compared once, as (first, second) with first < second
+            size_t key = i < j ? (size_t)i * n + j : (size_t)j * n + i;
+            if (i == j)
+            {
+                fprintf(file, "\t%s", MATRIX_DIAGONAL);
+            }
+            else if (!context->pairCompared[key] || (i > j && context->options->anchored))
+            {
+                fprintf(file, "\t%s", MATRIX_MISSING_SCORE);
+            }
+            else
+            {
+                fprintf(file, "\t%d", context->pairScores[key]);
+            }
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+ScoreCache *openScoreCache(const char *fileName, int capacity)
+{
+    ScoreCache *cache = (ScoreCache *)malloc(sizeof(ScoreCache));
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->fileDescriptor = open(fileName, O_RDWR | O_CREAT, CACHE_FILE_PERMISSIONS);
+    if (cache->fileDescriptor < 0)
+    {
+        free(cache);
+        return NULL;
+    }
+    // the exclusive lock makes sure only one process creates the table of a new file
+    lockScoreCache(cache, F_WRLCK);
+    struct stat status;
+    ScoreCacheHeader header;
+    int valid = fstat(cache->fileDescriptor, &status) == 0;
+    if (valid && status.st_size == 0)
+    {
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.capacity = (uint32_t)capacity;
+        header.clock = 0;
+        status.st_size = (off_t)(sizeof(ScoreCacheHeader) + capacity * sizeof(ScoreCacheEntry));
+        valid = ftruncate(cache->fileDescriptor, status.st_size) == 0 &&
+                pwrite(cache->fileDescriptor, &header, sizeof(header), 0) == sizeof(header);
+    }
+    else if (valid)
+    {
+        valid = pread(cache->fileDescriptor, &header, sizeof(header), 0) == sizeof(header) &&
+                header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+                header.capacity > 0 && (size_t)status.st_size ==
+                sizeof(ScoreCacheHeader) + header.capacity * sizeof(ScoreCacheEntry);
+    }
+    void *mapping = MAP_FAILED;
+    if (valid)
+    {
+        cache->mappedSize = (size_t)status.st_size;
+        mapping = mmap(NULL, cache->mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       cache->fileDescriptor, 0);
+    }
+    lockScoreCache(cache, F_UNLCK);
+    if (mapping == MAP_FAILED)
+    {
+        close(cache->fileDescriptor);
+        free(cache);
+        return NULL;
+    }
+    cache->header = (ScoreCacheHeader *)mapping;
+    cache->entries = (ScoreCacheEntry *)(cache->header + 1);
+    // the mapping isn't allocated, but its pages are resident once touched
+    if (memoryReport)
+    {
+        chargeMemory(MEMORY_CACHES, (long long)cache->mappedSize);
+    }
+    return cache;
+}
+
+void closeScoreCache(ScoreCache *cache)
+{
+    if (cache == NULL)
+    {
+        return;
+    }
+    munmap(cache->header, cache->mappedSize);
+    if (memoryReport)
+    {
+        chargeMemory(MEMORY_CACHES, -(long long)cache->mappedSize);
+    }
+    close(cache->fileDescriptor);
+    free(cache);
+}
+
+void lockScoreCache(ScoreCache *cache, short lockType)
+{
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = lockType;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(cache->fileDescriptor, F_SETLKW, &lock) != 0 && errno == EINTR)
+    {
+    }
+}
+
+void makeScoreCacheKey(const ComparisonContext *context, int first, int second,
+                       ScoreCacheEntry *key)
+{
+    memset(key, 0, sizeof(ScoreCacheEntry));
+    key->hash1 = context->hashes[first];
+    key->hash2 = context->hashes[second];
+    key->length1 = context->lengths[first];
+    key->length2 = context->lengths[second];
+    key->m = context->m;
+    key->s = context->s;
+    key->g = context->g;
+    key->mode = getScoringMode(context->options);
+}
+
+int matchScoreCacheEntry(const ScoreCacheEntry *entry, const ScoreCacheEntry *key)
+{
+    return entry->lastUse != 0 && entry->hash1 == key->hash1 && entry->hash2 == key->hash2 &&
+           entry->length1 == key->length1 && entry->length2 == key->length2 &&
+           entry->m == key->m && entry->s == key->s && entry->g == key->g &&
+           entry->mode == key->mode;
+}
+
+uint32_t getScoreCacheSlot(const ScoreCache *cache, const ScoreCacheEntry *key)
+{
+    uint64_t hash = mixHash(key->hash1 ^ rotateLeft(key->hash2, SEQUENCE_HASH_WORD_ROTATION) ^
+                            ((uint64_t)(uint32_t)key->m << 32 | (uint32_t)key->s) ^
+                            ((uint64_t)(uint32_t)key->g << 32 | (uint32_t)key->mode));
+    return (uint32_t)(hash % cache->header->capacity);
+}
+
+int lookupScoreCache(ScoreCache *cache, const ScoreCacheEntry *key, int *scoreAddress)
+{
+    int hit = 0;
+    uint32_t capacity = cache->header->capacity, slot = getScoreCacheSlot(cache, key);
+    lockScoreCache(cache, F_RDLCK);
+    for (int probe = 0; probe < CACHE_PROBE_LIMIT && probe < (int)capacity; probe++)
+    {
+        ScoreCacheEntry *entry = &cache->entries[(slot + probe) % capacity];
+        if (matchScoreCacheEntry(entry, key))
+        {
+            *scoreAddress = entry->score;
+            // readers share the lock, so the recency of the entry is advanced atomically
+            uint64_t now = __atomic_add_fetch(&cache->header->clock, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&entry->lastUse, now, __ATOMIC_RELAXED);
+            hit = 1;
+            break;
+        }
+    }
+    lockScoreCache(cache, F_UNLCK);
+    if (hit)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    return hit;
+}
+
+void storeScoreCache(ScoreCache *cache, const ScoreCacheEntry *key, int score)
+{
+    uint32_t capacity = cache->header->capacity, slot = getScoreCacheSlot(cache, key);
+    lockScoreCache(cache, F_WRLCK);
+    ScoreCacheEntry *victim = NULL;
+    for (int probe = 0; probe < CACHE_PROBE_LIMIT && probe < (int)capacity; probe++)
+    {
+        ScoreCacheEntry *entry = &cache->entries[(slot + probe) % capacity];
+        if (matchScoreCacheEntry(entry, key) || entry->lastUse == 0)
+        {
+            victim = entry;
+            break;
+        }
+        if (victim == NULL || entry->lastUse < victim->lastUse)
+        {
+            victim = entry;
+        }
+    }
+    *victim = *key;
+    victim->score = score;
+    victim->lastUse = __atomic_add_fetch(&cache->header->clock, 1, __ATOMIC_RELAXED);
+    lockScoreCache(cache, F_UNLCK);
+}
+
+int *buildSeedIndex(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                    const ProgramOptions *options, int *seedsCountAddress)
+{
+    size_t totalLength = 0, maximalLength = 0;
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        size_t length = strlen(sequences[i]);
+        totalLength += length;
+        if (length > maximalLength)
+        {
+            maximalLength = length;
+        }
+    }
+    int *sharedSeeds = (int *)calloc((size_t)numberOfSequences * numberOfSequences, sizeof(int));
+    Seed *seeds = (Seed *)malloc((totalLength + 1) * sizeof(Seed));
+    uint64_t *kmerHashes = (uint64_t *)malloc((maximalLength + 1) * sizeof(uint64_t));
+    if (sharedSeeds == NULL || seeds == NULL || kmerHashes == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        free(sharedSeeds);
+        free(seeds);
+        free(kmerHashes);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    int seedsCount = 0;
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        int collected = collectMinimizers(sequences[i], i, options->kmerLength,
+                                          options->windowLength, kmerHashes, seeds + seedsCount);
+        if (collected == 0)
+        {
+            for (int j = 0; j < numberOfSequences; j++)
+            {
+                sharedSeeds[i * numberOfSequences + j] = -1;
+                sharedSeeds[j * numberOfSequences + i] = -1;
+            }
+        }
+        seedsCount += collected;
+    }
+    // sorting groups equal minimizers together, so every group is a list of sequences sharing it
+    qsort(seeds, (size_t)seedsCount, sizeof(Seed), compareSeeds);
+    int distinctSeeds = 0;
+    for (int start = 0, end = 0; start < seedsCount; start = end)
+    {
+        while (end < seedsCount && seeds[end].hash == seeds[start].hash)
+        {
+            end++;
+        }
+        distinctSeeds++;
+        for (int a = start; a < end; a++)
+        {
+            for (int b = a + 1; b < end; b++)
+            {
+                int first = seeds[a].sequenceIndex, second = seeds[b].sequenceIndex;
+                if (first == second || sharedSeeds[first * numberOfSequences + second] < 0)
+                {
+                    continue;
+                }
+                sharedSeeds[first * numberOfSequences + second]++;
+                sharedSeeds[second * numberOfSequences + first]++;
+            }
+        }
+    }
+    free(seeds);
+    free(kmerHashes);
+    *seedsCountAddress = distinctSeeds;
+    return sharedSeeds;
+}
+
+int collectMinimizers(const char *sequence, int sequenceIndex, int kmerLength, int windowLength,
+                      uint64_t *kmerHashes, Seed *seeds)
+{
+    int kmersCount = hashKmers(sequence, (int)strlen(sequence), kmerLength, kmerHashes);
+    if (kmersCount == 0)
+    {
+        return 0;
+    }
+    int window = windowLength < kmersCount ? windowLength : kmersCount;
+    int collected = 0, minimumPosition = -1;
+    for (int end = window - 1; end < kmersCount; end++)
+    {
+        int start = end - window + 1;
+        if (minimumPosition < start)
+        {
+            // the previous minimum left the window, so the whole window is rescanned
+            minimumPosition = start;
+            for (int i = start + 1; i <= end; i++)
+            {
+                if (kmerHashes[i] < kmerHashes[minimumPosition])
+                {
+                    minimumPosition = i;
+                }
+            }
+        }
+        else if (kmerHashes[end] < kmerHashes[minimumPosition])
+        {
+            minimumPosition = end;
+        }
+        else
+        {
+            continue;
+        }
+        seeds[collected].hash = kmerHashes[minimumPosition];
+        seeds[collected].sequenceIndex = sequenceIndex;
+        collected++;
+    }
+    // a k-mer repeated in the sequence is counted once, so a single sequence never inflates a pair
+    qsort(seeds, (size_t)collected, sizeof(Seed), compareSeeds);
+    int distinct = 0;
+    for (int i = 0; i < collected; i++)
+    {
+        if (distinct == 0 || seeds[i].hash != seeds[distinct - 1].hash)
+        {
+            seeds[distinct++] = seeds[i];
+        }
+    }
+    return distinct;
+}
+
+int hashKmers(const char *sequence, int length, int kmerLength, uint64_t *kmerHashes)
+{
+    if (length < kmerLength)
+    {
+        return 0;
+    }
+    uint64_t power = 1, rolling = 0;
+    for (int i = 0; i < kmerLength - 1; i++)
+    {
+        power *= KMER_HASH_BASE;
+    }
+    for (int i = 0; i < length; i++)
+    {
+        if (i >= kmerLength)
+        {
+            rolling -= power * (unsigned char)sequence[i - kmerLength];
+        }
+        rolling = rolling * KMER_HASH_BASE + (unsigned char)sequence[i];
+        if (i >= kmerLength - 1)
+        {
+            kmerHashes[i - kmerLength + 1] = mixHash(rolling);
+        }
+    }
+    return length - kmerLength + 1;
+}
+
+uint64_t mixHash(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+int compareSeeds(const void *first, const void *second)
+{
+    const Seed *firstSeed = (const Seed *)first, *secondSeed = (const Seed *)second;
+    if (firstSeed->hash != secondSeed->hash)
+    {
+        return firstSeed->hash < secondSeed->hash ? -1 : 1;
+    }
+    return firstSeed->sequenceIndex - secondSeed->sequenceIndex;
+}
+
+long long getTimeNanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+
+int scoreTwoSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      char *sequence1, char *sequence2, int m, int s, int g)
+{
+    int tableRows = (int)strlen(sequence1) + 1, tableColumns = (int)strlen(sequence2) + 1;
+    int **table = NULL;
+    allocateTable(sequencesNames, sequences, numberOfSequences, &table, tableRows, tableColumns);
+    if (table == NULL)
+    {
+        return 0;
+    }
+    fillTable(sequence1, sequence2, table, tableRows, tableColumns, m, s, g);
+    int score = table[tableRows - 1][tableColumns - 1];
+    freeTableMemory(table, tableRows);
+    return score;
+}
+
+int scoreWithRollingRow(const char *sequence1, int length1, const char *sequence2, int length2,
+                        int m, int s, int g, int *row)
+{
+    for (int j = 0; j <= length2; j++)
+    {
+        row[j] = j * g;
+    }
+    advanceRollingRow(row, 0, sequence1, length1, sequence2, length2, m, s, g);
+    return row[length2];
+}
+
+void advanceRollingRow(int *row, int rowIndex, const char *residues, int count,
+                       const char *sequence2, int length2, int m, int s, int g)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int diagonal = row[0];
+        row[0] = (rowIndex + i + 1) * g;
+        for (int j = 1; j <= length2; j++)
+        {
+            int up = row[j];
+            int firstMatchScore = diagonal + (residues[i] == sequence2[j - 1] ? m : s);
+            row[j] = max3(firstMatchScore, row[j - 1] + g, up + g);
+            diagonal = up;
+        }
+    }
+}
+
+void fillDirections(int *row, int rowIndex, const char *residues, int count,
+                    const char *sequence2, int length2, int m, int s, int g,
+                    unsigned char *directions)
+{
+    size_t rowBytes = getDirectionsRowBytes(length2);
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char *directionsRow = directions + i * rowBytes;
+        memset(directionsRow, 0, rowBytes);
+        int diagonal = row[0];
+        row[0] = (rowIndex + i + 1) * g;
+        for (int j = 1; j <= length2; j++)
+        {
+            int up = row[j] + g, left = row[j - 1] + g;
+            int diagonalScore = diagonal + (residues[i] == sequence2[j - 1] ? m : s);
+            int gapScore = max(up, left);
+            int direction = up >= left ? DIRECTION_UP : DIRECTION_LEFT;
+            if (diagonalScore > gapScore)
+            {
+                direction = DIRECTION_DIAGONAL;
+            }
+            else if (diagonalScore == gapScore)
+            {
+                direction = DIRECTION_TIE;
+            }
+            diagonal = row[j];
+            row[j] = max(diagonalScore, gapScore);
+            directionsRow[(j - 1) / DIRECTIONS_PER_BYTE] |=
+                (unsigned char)(direction << ((j - 1) % DIRECTIONS_PER_BYTE * DIRECTION_BITS));
+        }
+    }
+}
+
+size_t getDirectionsRowBytes(int length2)
+{
+    return ((size_t)length2 + DIRECTIONS_PER_BYTE - 1) / DIRECTIONS_PER_BYTE;
+}
+
+void traceDirections(const char *sequence1, const char *sequence2, int length2,
+                     const unsigned char *directions, int firstRow, int *iAddress, int *jAddress,
+                     char *aligned1, char *aligned2, int *lengthAddress)
+{
+    size_t rowBytes = getDirectionsRowBytes(length2);
+    int i = *iAddress, j = *jAddress, length = *lengthAddress;
+    while (i > firstRow || (firstRow == 0 && j > 0))
+    {
+        int direction = DIRECTION_UP;
+        if (i == 0)
+        {
+            direction = DIRECTION_LEFT;
+        }
+        else if (j > 0)
+        {
+            unsigned char cell = directions[(size_t)(i - 1 - firstRow) * rowBytes +
+                                            (j - 1) / DIRECTIONS_PER_BYTE];
+            direction = cell >> ((j - 1) % DIRECTIONS_PER_BYTE * DIRECTION_BITS) & DIRECTION_MASK;
+        }
+        if (direction == DIRECTION_DIAGONAL || direction == DIRECTION_TIE)
+        {
+            aligned1[length] = sequence1[--i];
+            aligned2[length++] = sequence2[--j];
+        }
+        else if (direction == DIRECTION_UP)
+        {
+            aligned1[length] = sequence1[--i];
+            aligned2[length++] = GAP_CHAR;
+        }
+        else
+        {
+            aligned1[length] = GAP_CHAR;
+            aligned2[length++] = sequence2[--j];
+        }
+    }
+    *iAddress = i;
+    *jAddress = j;
+    *lengthAddress = length;
+}
+
+void reverseAlignment(char *aligned1, char *aligned2, int length)
+{
+    for (int k = 0; k < length / 2; k++)
+    {
+        char swap = aligned1[k];
+        aligned1[k] = aligned1[length - 1 - k];
+        aligned1[length - 1 - k] = swap;
+        swap = aligned2[k];
+        aligned2[k] = aligned2[length - 1 - k];
+        aligned2[length - 1 - k] = swap;
+    }
+    aligned1[length] = '\0';
+    aligned2[length] = '\0';
+}
+
+int traceOutOfCore(ComparisonContext *context, int first, int second,
+                   char *aligned1, char *aligned2, size_t memoryBudget)
+{
+    const char *sequence1 = context->sequences[first], *sequence2 = context->sequences[second];
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    const ProgramOptions *options = context->options;
+    size_t rowBytes = getDirectionsRowBytes(length2);
+    // every segment's directions fit the memory budget, and starts from a checkpoint row
+    int segmentRows = memoryBudget / rowBytes > 0 ? (int)(memoryBudget / rowBytes) : 1;
+    if (segmentRows > length1)
+    {
+        segmentRows = length1;
+    }
+    int segments = (length1 + segmentRows - 1) / segmentRows;
+    size_t checkpointBytes = ((size_t)length2 + 1) * sizeof(int);
+    if (options->scratchLimit > 0 &&
+        (double)segments * checkpointBytes > (double)options->scratchLimit * BYTES_IN_MEGABYTE)
+    {
+        return -1;
+    }
+    size_t blockBytes = checkpointBytes > SCRATCH_BLOCK_BYTES ? checkpointBytes :
+                        SCRATCH_BLOCK_BYTES / checkpointBytes * checkpointBytes;
+    int *row = (int *)trackedMalloc(checkpointBytes, MEMORY_WORKSPACE);
+    unsigned char *directions = (unsigned char *)trackedMalloc((size_t)segmentRows * rowBytes + 1,
+                                                                 MEMORY_WORKSPACE);
+    char *block = (char *)trackedMalloc(blockBytes, MEMORY_WORKSPACE);
+    if (row == NULL || directions == NULL || block == NULL)
+    {
+        trackedFree(row);
+        trackedFree(directions);
+        trackedFree(block);
+        return 1;
+    }
+    int file = openScratchFile(options->scratchDirectory);
+    int failed = file < 0;
+    // the forward pass writes the checkpoint rows in blocks of as many rows as fit them
+    size_t blockUsed = 0;
+    off_t blockOffset = 0;
+    for (int j = 0; j <= length2; j++)
+    {
+        row[j] = j * context->g;
+    }
+    for (int segment = 0; !failed && segment < segments; segment++)
+    {
+        int start = segment * segmentRows;
+        memcpy(block + blockUsed, row, checkpointBytes);
+        blockUsed += checkpointBytes;
+        if (blockUsed + checkpointBytes > blockBytes || segment == segments - 1)
+        {
+            failed = writeFully(file, block, blockUsed, blockOffset);
+            blockOffset += (off_t)blockUsed;
+            blockUsed = 0;
+        }
+        if (segment < segments - 1)
+        {
+            advanceRollingRow(row, start, sequence1 + start, segmentRows, sequence2, length2,
+                              context->m, context->s, context->g);
+        }
+    }
+    // the traceback recomputes every segment from its checkpoint, from the last one backwards,
+    // reading the checkpoints back a block at a time
+    int i = length1, j = length2, length = 0;
+    int blockRows = (int)(blockBytes / checkpointBytes), blockFirst = segments;
+    for (int segment = segments - 1; !failed && segment >= 0; segment--)
+    {
+        int start = segment * segmentRows;
+        if (segment < blockFirst)
+        {
+            blockFirst = segment / blockRows * blockRows;
+            int rows = segments - blockFirst < blockRows ? segments - blockFirst : blockRows;
+            failed = readFully(file, block, (size_t)rows * checkpointBytes,
+                               (off_t)blockFirst * (off_t)checkpointBytes);
+        }
+        if (!failed)
+        {
+            memcpy(row, block + (size_t)(segment - blockFirst) * checkpointBytes, checkpointBytes);
+            fillDirections(row, start, sequence1 + start, i - start, sequence2, length2,
+                           context->m, context->s, context->g, directions);
+            traceDirections(sequence1, sequence2, length2, directions, start, &i, &j,
+                            aligned1, aligned2, &length);
+        }
+    }
+    if (file >= 0)
+    {
+        close(file);
+    }
+    trackedFree(row);
+    trackedFree(directions);
+    trackedFree(block);
+    if (failed)
+    {
+        return -1;
+    }
+    reverseAlignment(aligned1, aligned2, length);
+    return 0;
+}
+
+int openScratchFile(const char *directory)
+{
+    size_t pathLength = strlen(directory) + strlen(SCRATCH_FILE_TEMPLATE) + 2;
+    char *path = (char *)malloc(pathLength);
+    if (path == NULL)
+    {
+        return -1;
+    }
+    snprintf(path, pathLength, "%s/%s", directory, SCRATCH_FILE_TEMPLATE);
+    int file = mkstemp(path);
+    if (file >= 0)
+    {
+        unlink(path);
+    }
+    free(path);
+    return file;
+}
+
+int writeFully(int file, const void *buffer, size_t bytes, off_t offset)
+{
+    const char *bytesLeft = (const char *)buffer;
+    while (bytes > 0)
+    {
+        ssize_t written = pwrite(file, bytesLeft, bytes, offset);
+        if (written <= 0)
+        {
+            return -1;
+        }
+        bytesLeft += written;
+        bytes -= (size_t)written;
+        offset += written;
+    }
+    return 0;
+}
+
+int readFully(int file, void *buffer, size_t bytes, off_t offset)
+{
+    char *bytesLeft = (char *)buffer;
+    while (bytes > 0)
+    {
+        ssize_t bytesRead = pread(file, bytesLeft, bytes, offset);
+        if (bytesRead <= 0)
+        {
+            return -1;
+        }
+        bytesLeft += bytesRead;
+        bytes -= (size_t)bytesRead;
+        offset += bytesRead;
+    }
+    return 0;
+}
+
+void printAlignment(ComparisonContext *context, int first, int second)
+{
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    const ProgramOptions *options = context->options;
+    char *aligned = (char *)trackedMalloc(2 * ((size_t)length1 + length2 + 1), MEMORY_OUTPUT);
+    if (aligned == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, context->numberOfSequences);
+        freeSequencesMemory(context->sequences, context->numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    char *aligned1 = aligned, *aligned2 = aligned + length1 + length2 + 1;
+    int strategy, traced = -1;
+    if (options->memoryLimit > 0)
+    {
+        size_t limit = (size_t)options->memoryLimit * BYTES_IN_MEGABYTE;
+        // the out-of-core directions take what the limit leaves past the checkpoint row, the
+        // scratch block and the aligned rows, so the whole limit is reserved for them
+        size_t outOfCoreBytes = getStrategyBytes(STRATEGY_OUT_OF_CORE, length1, length2, 1);
+        size_t directionsBudget = OUT_OF_CORE_MINIMAL_SEGMENT_ROWS *
+                                  getDirectionsRowBytes(length2) +
+                                  (outOfCoreBytes < limit ? limit - outOfCoreBytes : 0);
+        for (strategy = planPair(context, first, second, 1);
+             traced != 0 && strategy < STRATEGY_SCORE_ONLY; strategy += traced != 0)
+        {
+            size_t bytes = strategy == STRATEGY_OUT_OF_CORE ? limit :
+                           getStrategyBytes(strategy, length1, length2, 1);
+            reserveMemory(context, bytes);
+            traced = traceWithStrategy(context, strategy, first, second, aligned1, aligned2,
+                                       directionsBudget);
+            releaseMemory(context, bytes);
+        }
+        traced = strategy == STRATEGY_SCORE_ONLY ? -1 : traced;
+        context->strategyCounts[strategy]++;
+    }
+    else
+    {
+        size_t memoryBudget = (size_t)options->tracebackMemory * BYTES_IN_MEGABYTE;
+        strategy = (size_t)length1 * getDirectionsRowBytes(length2) <= memoryBudget ?
+                   STRATEGY_DIRECTIONS : STRATEGY_OUT_OF_CORE;
+        traced = traceWithStrategy(context, strategy, first, second, aligned1, aligned2,
+                                   memoryBudget);
+    }
+    if (traced > 0)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        trackedFree(aligned);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, context->numberOfSequences);
+        freeSequencesMemory(context->sequences, context->numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    if (traced == 0)
+    {
+        printf("%s\n%s\n", aligned1, aligned2);
+    }
+    else if (options->memoryLimit > 0)
+    {
+        fprintf(stderr, "Memory: no traceback of %s to %s within the memory limit\n",
+                context->sequencesNames[first], context->sequencesNames[second]);
+    }
+    else
+    {
+        fprintf(stderr, "Error - no traceback of %s to %s within the scratch budget\n",
+                context->sequencesNames[first], context->sequencesNames[second]);
+    }
+    trackedFree(aligned);
+}
+
+int traceWithStrategy(ComparisonContext *context, int strategy, int first, int second,
+                      char *aligned1, char *aligned2, size_t memoryBudget)
+{
+    char *sequence1 = context->sequences[first], *sequence2 = context->sequences[second];
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    int m = context->m, s = context->s, g = context->g;
+    if (strategy == STRATEGY_FULL_TABLE)
+    {
+        return traceFullTable(sequence1, length1, sequence2, length2, m, s, g, aligned1, aligned2);
+    }
+    if (strategy == STRATEGY_OUT_OF_CORE)
+    {
+        return traceOutOfCore(context, first, second, aligned1, aligned2, memoryBudget);
+    }
+    if (strategy == STRATEGY_HIRSCHBERG)
+    {
+        return traceHirschberg(sequence1, length1, sequence2, length2, m, s, g, aligned1,
+                               aligned2);
+    }
+    int *row = (int *)trackedMalloc(((size_t)length2 + 1) * sizeof(int), MEMORY_WORKSPACE);
+    unsigned char *directions = (unsigned char *)trackedMalloc(
+        (size_t)length1 * getDirectionsRowBytes(length2) + 1, MEMORY_WORKSPACE);
+    if (row == NULL || directions == NULL)
+    {
+        trackedFree(row);
+        trackedFree(directions);
+        return 1;
+    }
+    for (int j = 0; j <= length2; j++)
+    {
+        row[j] = j * g;
+    }
+    fillDirections(row, 0, sequence1, length1, sequence2, length2, m, s, g, directions);
+    int i = length1, j = length2, length = 0;
+    traceDirections(sequence1, sequence2, length2, directions, 0, &i, &j, aligned1, aligned2,
+                    &length);
+    reverseAlignment(aligned1, aligned2, length);
+    trackedFree(directions);
+    trackedFree(row);
+    return 0;
+}
+
+size_t getStrategyBytes(int strategy, int length1, int length2, int traceback)
+{
+    size_t rowBytes = ((size_t)length2 + 1) * sizeof(int);
+    size_t directionsRowBytes = getDirectionsRowBytes(length2);
+    size_t alignedBytes = traceback ? 2 * ((size_t)length1 + length2 + 1) : 0;
+    size_t hirschbergBytes = directionsRowBytes > HIRSCHBERG_BASE_BYTES ? directionsRowBytes :
+                             HIRSCHBERG_BASE_BYTES;
+    switch (strategy)
+    {
+        case STRATEGY_FULL_TABLE:
+            return ((size_t)length1 + 1) * (rowBytes + sizeof(int *)) + alignedBytes;
+        case STRATEGY_DIRECTIONS:
+            return (size_t)length1 * directionsRowBytes + rowBytes + alignedBytes;
+        case STRATEGY_OUT_OF_CORE:
+            return OUT_OF_CORE_MINIMAL_SEGMENT_ROWS * directionsRowBytes + rowBytes +
+                   (rowBytes > SCRATCH_BLOCK_BYTES ? rowBytes : SCRATCH_BLOCK_BYTES) + alignedBytes;
+        case STRATEGY_HIRSCHBERG:
+            return 2 * rowBytes + hirschbergBytes + alignedBytes;
+        default:
+            return rowBytes + alignedBytes;
+    }
+}
+
+int planPair(const ComparisonContext *context, int first, int second, int traceback)
+{
+    size_t limit = (size_t)context->options->memoryLimit * BYTES_IN_MEGABYTE;
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    // a score takes a rolling row, whatever the limit
+    for (int strategy = 0; traceback && strategy < STRATEGY_SCORE_ONLY; strategy++)
+    {
+        if (getStrategyBytes(strategy, length1, length2, traceback) <= limit)
+        {
+            return strategy;
+        }
+    }
+    return STRATEGY_SCORE_ONLY;
+}
+
+void reserveMemory(ComparisonContext *context, size_t bytes)
+{
+    size_t limit = (size_t)context->options->memoryLimit * BYTES_IN_MEGABYTE;
+    long long waitBegin = beginTrace();
+    int waited = 0;
+    pthread_mutex_lock(&context->lock);
+    while (limit > 0 && context->activePairs > 0 && context->reservedMemory + bytes > limit)
+    {
+        pthread_cond_wait(&context->memoryReleased, &context->lock);
+        waited = 1;
+    }
+    // a reservation that didn't block isn't a wait
+    if (waited)
+    {
+        endTrace("memory wait", waitBegin, -1, -1);
+    }
+    context->reservedMemory += bytes;
+    context->activePairs++;
+    pthread_mutex_unlock(&context->lock);
+}
+
+void releaseMemory(ComparisonContext *context, size_t bytes)
+{
+    pthread_mutex_lock(&context->lock);
+    context->reservedMemory -= bytes;
+    context->activePairs--;
+    pthread_cond_broadcast(&context->memoryReleased);
+    pthread_mutex_unlock(&context->lock);
+}
+
+int scoreWithinMemoryLimit(ComparisonContext *context, int first, int second)
+{
+    char *sequence1 = context->sequences[first], *sequence2 = context->sequences[second];
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    int strategy = planPair(context, first, second, 0);
+    size_t bytes = getStrategyBytes(strategy, length1, length2, 0);
+    int score = 0;
+    reserveMemory(context, bytes);
+    int *row = (int *)trackedMalloc(((size_t)length2 + 1) * sizeof(int), MEMORY_WORKSPACE);
+    if (row == NULL && flagWorkerFailure())
+    {
+        releaseMemory(context, bytes);
+        return 0;
+    }
+    if (row == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, context->numberOfSequences);
+        freeSequencesMemory(context->sequences, context->numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    score = scoreWithRollingRow(sequence1, length1, sequence2, length2, context->m, context->s,
+                                context->g, row);
+    trackedFree(row);
+    releaseMemory(context, bytes);
+    // the strategy of a traced pair is counted by its traceback
+    if (!context->options->alignment)
+    {
+        pthread_mutex_lock(&context->lock);
+        context->strategyCounts[strategy]++;
+        pthread_mutex_unlock(&context->lock);
+    }
+    return score;
+}
+
+int **allocateTableBlock(int tableRows, int tableColumns)
+{
+    int **table = (int **)trackedMalloc((size_t)tableRows * sizeof(int *), MEMORY_WORKSPACE);
+    int *cells = (int *)trackedMalloc((size_t)tableRows * tableColumns * sizeof(int),
+                                       MEMORY_WORKSPACE);
+    if (table == NULL || cells == NULL)
+    {
+        trackedFree(table);
+        trackedFree(cells);
+        return NULL;
+    }
+    for (int i = 0; i < tableRows; i++)
+    {
+        table[i] = cells + (size_t)i * tableColumns;
+    }
+    return table;
+}
+
+void freeTableBlock(int **table)
+{
+    if (table != NULL)
+    {
+        trackedFree(table[0]);
+        trackedFree(table);
+    }
+}
+
+int traceFullTable(char *sequence1, int length1, char *sequence2, int length2, int m, int s, int g,
+                   char *aligned1, char *aligned2)
+{
+    int **table = allocateTableBlock(length1 + 1, length2 + 1);
+    if (table == NULL)
+    {
+        return 1;
+    }
+    fillTable(sequence1, sequence2, table, length1 + 1, length2 + 1, m, s, g);
+    int i = length1, j = length2, length = 0;
+    while (i > 0 || j > 0)
+    {
+        if (i > 0 && j > 0 &&
+            table[i][j] == table[i - 1][j - 1] + (sequence1[i - 1] == sequence2[j - 1] ? m : s))
+        {
+            aligned1[length] = sequence1[--i];
+            aligned2[length++] = sequence2[--j];
+        }
+        else if (i > 0 && table[i][j] == table[i - 1][j] + g)
+        {
+            aligned1[length] = sequence1[--i];
+            aligned2[length++] = GAP_CHAR;
+        }
+        else
+        {
+            aligned1[length] = GAP_CHAR;
+            aligned2[length++] = sequence2[--j];
+        }
+    }
+    reverseAlignment(aligned1, aligned2, length);
+    freeTableBlock(table);
+    return 0;
+}
+
+int traceHirschberg(const char *sequence1, int length1, const char *sequence2, int length2,
+                    int m, int s, int g, char *aligned1, char *aligned2)
+{
+    size_t directionsBytes = getDirectionsRowBytes(length2);
+    directionsBytes = directionsBytes > HIRSCHBERG_BASE_BYTES ? directionsBytes :
+                      HIRSCHBERG_BASE_BYTES;
+    int *rows = (int *)trackedMalloc(2 * ((size_t)length2 + 1) * sizeof(int), MEMORY_WORKSPACE);
+    unsigned char *directions = (unsigned char *)trackedMalloc(directionsBytes, MEMORY_WORKSPACE);
+    if (rows == NULL || directions == NULL)
+    {
+        trackedFree(rows);
+        trackedFree(directions);
+        return 1;
+    }
+    int length = 0;
+    alignHirschberg(sequence1, length1, sequence2, length2, m, s, g, rows, directions,
+                    directionsBytes, aligned1, aligned2, &length);
+    aligned1[length] = '\0';
+    aligned2[length] = '\0';
+    trackedFree(rows);
+    trackedFree(directions);
+    return 0;
+}
+
+void alignHirschberg(const char *sequence1, int length1, const char *sequence2, int length2,
+                     int m, int s, int g, int *rows, unsigned char *directions,
+                     size_t directionsBytes, char *aligned1, char *aligned2, int *lengthAddress)
+{
+    if (length1 <= 1 || (size_t)length1 * getDirectionsRowBytes(length2) <= directionsBytes)
+    {
+        for (int j = 0; j <= length2; j++)
+        {
+            rows[j] = j * g;
+        }
+        fillDirections(rows, 0, sequence1, length1, sequence2, length2, m, s, g, directions);
+        int i = length1, j = length2, start = *lengthAddress;
+        traceDirections(sequence1, sequence2, length2, directions, 0, &i, &j, aligned1, aligned2,
+                        lengthAddress);
+        reverseAlignment(aligned1 + start, aligned2 + start, *lengthAddress - start);
+        return;
+    }
+    int middle = length1 / 2;
+    int *forward = rows, *backward = rows + length2 + 1;
+    scoreWithRollingRow(sequence1, middle, sequence2, length2, m, s, g, forward);
+    fillSuffixRow(sequence1 + middle, length1 - middle, sequence2, length2, m, s, g, backward);
+    int split = 0;
+    for (int j = 1; j <= length2; j++)
+    {
+        if (forward[j] + backward[j] > forward[split] + backward[split])
+        {
+            split = j;
+        }
+    }
+    alignHirschberg(sequence1, middle, sequence2, split, m, s, g, rows, directions,
+                    directionsBytes, aligned1, aligned2, lengthAddress);
+    alignHirschberg(sequence1 + middle, length1 - middle, sequence2 + split, length2 - split,
+                    m, s, g, rows, directions, directionsBytes, aligned1, aligned2,
+                    lengthAddress);
+}
+
+void fillSuffixRow(const char *sequence1, int length1, const char *sequence2, int length2,
+                   int m, int s, int g, int *row)
+{
+    for (int j = 0; j <= length2; j++)
+    {
+        row[j] = (length2 - j) * g;
+    }
+    for (int i = length1 - 1; i >= 0; i--)
+    {
+        int diagonal = row[length2];
+        row[length2] = (length1 - i) * g;
+        for (int j = length2 - 1; j >= 0; j--)
+        {
+            int down = row[j];
+            row[j] = max3(diagonal + (sequence1[i] == sequence2[j] ? m : s), row[j + 1] + g,
+                          down + g);
+            diagonal = down;
+        }
+    }
+}
+
+void comparePairsList(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g, const ProgramOptions *options)
+{
+    FILE *file = fopen(options->pairsFileName, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening pairs file\n");
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    RequestedPair *pairs = NULL;
+    int pairsCount = 0;
+    int invalidLine = readPairsList(file, sequencesNames, numberOfSequences, &pairs, &pairsCount);
+    fclose(file);
+    if (invalidLine > 0)
+    {
+        fprintf(stderr, "Error - invalid pair in line %d of the pairs file\n", invalidLine);
+        free(pairs);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    ComparisonContext context;
+    initializeComparisonContext(&context, sequencesNames, sequences, numberOfSequences, m, s, g,
+                                options);
+    int maximalLength = 0;
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        maximalLength = context.lengths[i] > maximalLength ? context.lengths[i] : maximalLength;
+    }
+    // the pairs stay in the file order, and are scored in the order of the schedule
+    RequestedPair *schedule = (RequestedPair *)malloc(((size_t)pairsCount + 1) *
+                                                      sizeof(RequestedPair));
+    int *scores = (int *)trackedMalloc(((size_t)pairsCount + 1) * sizeof(int), MEMORY_OUTPUT);
+    char *scored = (char *)trackedCalloc((size_t)pairsCount + 1, sizeof(char), MEMORY_OUTPUT);
+    int *rows = (int *)trackedMalloc(2 * ((size_t)maximalLength + 1) * sizeof(int),
+                                     MEMORY_WORKSPACE);
+    QueryProfile profile;
+    profile.scores = (int *)trackedMalloc(((size_t)context.alphabetSize * maximalLength + 1) *
+                                          sizeof(int), MEMORY_WORKSPACE);
+    if (invalidLine < 0 || schedule == NULL || scores == NULL || scored == NULL || rows == NULL ||
+        profile.scores == NULL)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        free(pairs);
+        free(schedule);
+        trackedFree(scores);
+        trackedFree(scored);
+        trackedFree(rows);
+        trackedFree(profile.scores);
+        freeComparisonContext(&context);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    if (pairsCount > 0)
+    {
+        memcpy(schedule, pairs, pairsCount * sizeof(RequestedPair));
+    }
+    qsort(schedule, (size_t)pairsCount, sizeof(RequestedPair), compareRequestedPairs);
+    int printed = 0, profileQuery = -1;
+    for (int pair = 0; pair < pairsCount; pair++)
+    {
+        int query = schedule[pair].query, target = schedule[pair].target;
+        int score = 0;
+        // the exact score is symmetric, so every pair is scored from its query's profile
+        if (!findPairScore(&context, query, target, &score))
+        {
+            if (profileQuery != query)
+            {
+                profile.length = context.lengths[query];
+                buildQueryProfile(sequences[query], context.lengths[query], context.residueCodes,
+                                  context.alphabetSize, m, s, &profile);
+                profileQuery = query;
+            }
+            score = profileKernel(&profile, sequences[target], context.lengths[target],
+                                  context.residueCodes, g, rows);
+            storePairScore(&context, query, target, score);
+        }
+        scores[schedule[pair].request] = score;
+        scored[schedule[pair].request] = 1;
+        // once a query's pairs are done, the file order is streamed as far as it is scored
+        if (pair == pairsCount - 1 || schedule[pair + 1].query != query)
+        {
+            for (; printed < pairsCount && scored[printed]; printed++)
+            {
+                printScore(scores[printed], sequencesNames[pairs[printed].first],
+                           sequencesNames[pairs[printed].second]);
+            }
+            fflush(stdout);
+        }
+    }
+    free(schedule);
+    trackedFree(rows);
+    trackedFree(profile.scores);
+    freeComparisonContext(&context);
+    trackedFree(scores);
+    trackedFree(scored);
+    free(pairs);
+}
+
+int readPairsList(FILE *file, char *sequencesNames[], int numberOfSequences,
+                  RequestedPair **pairsAddress, int *pairsCountAddress)
+{
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    int capacity = 0, lineNumber = 0, result = 0;
+    *pairsAddress = NULL;
+    *pairsCountAddress = 0;
+    while (result == 0 && getline(&line, &lineCapacity, file) != -1)
+    {
+        lineNumber++;
+        char *token1 = strtok(line, " \t\r\n");
+        if (token1 == NULL)
+        {
+            continue;
+        }
+        char *token2 = strtok(NULL, " \t\r\n");
+        int first = findSequence(token1, sequencesNames, numberOfSequences);
+        int second = token2 == NULL ? -1 : findSequence(token2, sequencesNames, numberOfSequences);
+        if (first < 0 || second < 0 || strtok(NULL, " \t\r\n") != NULL)
+        {
+            result = lineNumber;
+            break;
+        }
+        if (*pairsCountAddress == capacity)
+        {
+            capacity = capacity == 0 ? numberOfSequences + 1 : 2 * capacity;
+            RequestedPair *grown = (RequestedPair *)realloc(*pairsAddress,
+                                                            capacity * sizeof(RequestedPair));
+            if (grown == NULL)
+            {
+                result = -1;
+                break;
+            }
+            *pairsAddress = grown;
+        }
+        RequestedPair *pair = &(*pairsAddress)[*pairsCountAddress];
+        pair->first = first;
+        pair->second = second;
+        pair->query = first < second ? first : second;
+        pair->target = first < second ? second : first;
+        pair->request = (*pairsCountAddress)++;
+    }
+    free(line);
+    return result;
+}
+
+int findSequence(char *token, char *sequencesNames[], int numberOfSequences)
+{
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        if (strcmp(sequencesNames[i], token) == 0)
+        {
+            return i;
+        }
+    }
+    int index = 0;
+    if (checkNumber(token, &index) || index < 0 || index >= numberOfSequences)
+    {
+        return -1;
+    }
+    return index;
+}
+
+int compareRequestedPairs(const void *first, const void *second)
+{
+    const RequestedPair *pair1 = (const RequestedPair *)first;
+    const RequestedPair *pair2 = (const RequestedPair *)second;
+    if (pair1->query != pair2->query)
+    {
+        return pair1->query - pair2->query;
+    }
+    if (pair1->target != pair2->target)
+    {
+        return pair1->target - pair2->target;
+    }
+    return pair1->request - pair2->request;
+}
+
+void *trackedMalloc(size_t bytes, int subsystem)
+{
+    if (!memoryReport)
+    {
+        return malloc(bytes);
+    }
+    MemoryHeader *header = (MemoryHeader *)malloc(sizeof(MemoryHeader) + bytes);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    header->allocation.bytes = bytes;
+    header->allocation.subsystem = subsystem;
+    chargeMemory(subsystem, (long long)bytes);
+    return header + 1;
+}
+
+void *trackedCalloc(size_t count, size_t bytes, int subsystem)
+{
+    if (!memoryReport)
+    {
+        return calloc(count, bytes);
+    }
+    if (bytes > 0 && count > (SIZE_MAX - sizeof(MemoryHeader)) / bytes)
+    {
+        return NULL;
+    }
+    void *pointer = trackedMalloc(count * bytes, subsystem);
+    if (pointer != NULL)
+    {
+        memset(pointer, 0, count * bytes);
+    }
+    return pointer;
+}
+
+void *trackedRealloc(void *pointer, size_t bytes, int subsystem)
+{
+    if (!memoryReport)
+    {
+        return realloc(pointer, bytes);
+    }
+    if (pointer == NULL)
+    {
+        return trackedMalloc(bytes, subsystem);
+    }
+    MemoryHeader *header = (MemoryHeader *)pointer - 1;
+    size_t oldBytes = header->allocation.bytes;
+    int oldSubsystem = header->allocation.subsystem;
+    MemoryHeader *grown = (MemoryHeader *)realloc(header, sizeof(MemoryHeader) + bytes);
+    if (grown == NULL)
+    {
+        return NULL;
+    }
+    chargeMemory(oldSubsystem, -(long long)oldBytes);
+    chargeMemory(subsystem, (long long)bytes);
+    // a reallocation is counted as one more allocation
+    grown->allocation.bytes = bytes;
+    grown->allocation.subsystem = subsystem;
+    return grown + 1;
+}
+
+void trackedFree(void *pointer)
+{
+    if (!memoryReport || pointer == NULL)
+    {
+        free(pointer);
+        return;
+    }
+    MemoryHeader *header = (MemoryHeader *)pointer - 1;
+    chargeMemory(header->allocation.subsystem, -(long long)header->allocation.bytes);
+    free(header);
+}
+
+void chargeMemory(int subsystem, long long bytes)
+{
+    MemoryAccount *accounts[] = {&memoryAccounts[subsystem], &memoryTotal};
+    for (int account = 0; account < 2; account++)
+    {
+        long long live = __atomic_add_fetch(&accounts[account]->live, bytes, __ATOMIC_RELAXED);
+        if (bytes > 0)
+        {
+            __atomic_add_fetch(&accounts[account]->allocations, 1, __ATOMIC_RELAXED);
+            raisePeak(&accounts[account]->peak, live);
+        }
+    }
+}
+
+void raisePeak(long long *peak, long long value)
+{
+    long long current = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(peak, &current, value, 1, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+    {
+    }
+}
+
+void printMemoryReport(void)
+{
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEMS_COUNT; subsystem++)
+    {
+        const MemoryAccount *account = &memoryAccounts[subsystem];
+        fprintf(stderr, "Memory: %-9s peak %12lld bytes, live %12lld bytes, %lld allocations\n",
+                MEMORY_SUBSYSTEM_NAMES[subsystem], account->peak, account->live,
+                account->allocations);
+    }
+    struct rusage usage;
+    // the peak of the sum is lower than the sum of the peaks when the peaks came at other times
+    fprintf(stderr, "Memory: tracked peak %lld bytes (%.1f MB)", memoryTotal.peak,
+            (double)memoryTotal.peak / BYTES_IN_MEGABYTE);
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        // Linux reports the maximal resident set size in kilobytes
+        fprintf(stderr, ", peak RSS %.1f MB",
+                (double)usage.ru_maxrss * BYTES_IN_KILOBYTE / BYTES_IN_MEGABYTE);
+    }
+    fprintf(stderr, "\n");
+}
+
+int startMemorySeries(const char *fileName)
+{
+    memorySeries.file = fopen(fileName, "w");
+    if (memorySeries.file == NULL)
+    {
+        return -1;
+    }
+    fprintf(memorySeries.file, "milliseconds,total");
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEMS_COUNT; subsystem++)
+    {
+        fprintf(memorySeries.file, ",%s", MEMORY_SUBSYSTEM_NAMES[subsystem]);
+    }
+    fprintf(memorySeries.file, "\n");
+    memorySeries.start = getTimeNanoseconds();
+    memorySeries.stopped = 0;
+    if (pthread_create(&memorySeries.thread, NULL, sampleMemoryPeriodically, NULL) != 0)
+    {
+        fclose(memorySeries.file);
+        memorySeries.file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void stopMemorySeries(void)
+{
+    pthread_mutex_lock(&memorySeries.lock);
+    memorySeries.stopped = 1;
+    pthread_cond_signal(&memorySeries.stop);
+    pthread_mutex_unlock(&memorySeries.lock);
+    pthread_join(memorySeries.thread, NULL);
+    writeMemorySample();
+    if (fclose(memorySeries.file))
+    {
+        fprintf(stderr, "Error writing memory series file\n");
+    }
+    memorySeries.file = NULL;
+}
+
+void *sampleMemoryPeriodically(void *argument)
+{
+    (void)argument;
+    pthread_mutex_lock(&memorySeries.lock);
+    while (!memorySeries.stopped)
+    {
+        writeMemorySample();
+        struct timespec wakeTime;
+        clock_gettime(CLOCK_REALTIME, &wakeTime);
+        long long nanoseconds = wakeTime.tv_nsec + MEMORY_SERIES_INTERVAL_NANOSECONDS;
+        wakeTime.tv_sec += (time_t)(nanoseconds / NANOSECONDS_IN_SECOND);
+        wakeTime.tv_nsec = (long)(nanoseconds % NANOSECONDS_IN_SECOND);
+        pthread_cond_timedwait(&memorySeries.stop, &memorySeries.lock, &wakeTime);
+    }
+    pthread_mutex_unlock(&memorySeries.lock);
+    return NULL;
+}
+
+void writeMemorySample(void)
+{
+    fprintf(memorySeries.file, "%.1f,%lld",
+            (getTimeNanoseconds() - memorySeries.start) / NANOSECONDS_IN_MILLISECOND,
+            __atomic_load_n(&memoryTotal.live, __ATOMIC_RELAXED));
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEMS_COUNT; subsystem++)
+    {
+        fprintf(memorySeries.file, ",%lld",
+                __atomic_load_n(&memoryAccounts[subsystem].live, __ATOMIC_RELAXED));
+    }
+    fprintf(memorySeries.file, "\n");
+}
+
+int startTrace(void)
+{
+    void *buffers = NULL;
+    if (posix_memalign(&buffers, CACHE_LINE_BYTES, (MAXIMAL_THREADS + 1) * sizeof(TraceBuffer)))
+    {
+        return -1;
+    }
+    memset(buffers, 0, (MAXIMAL_THREADS + 1) * sizeof(TraceBuffer));
+    traceBuffers = (TraceBuffer *)buffers;
+    traceStart = getTimeNanoseconds();
+    return 0;
+}
+
+long long beginTrace(void)
+{
+    return traceBuffers != NULL ? getTimeNanoseconds() : 0;
+}
+
+void endTrace(const char *name, long long begin, int first, int second)
+{
+    if (traceBuffers == NULL)
+    {
+        return;
+    }
+    TraceBuffer *buffer = &traceBuffers[threadSlot];
+    if (buffer->events == NULL)
+    {
+        buffer->events = (TraceEvent *)malloc(TRACE_BUFFER_EVENTS * sizeof(TraceEvent));
+        if (buffer->events == NULL)
+        {
+            return;
+        }
+    }
+    TraceEvent *event = &buffer->events[buffer->count % TRACE_BUFFER_EVENTS];
+    event->name = name;
+    event->begin = begin;
+    event->end = getTimeNanoseconds();
+    event->first = first;
+    event->second = second;
+    buffer->count++;
+}
+
+int writeTrace(const char *fileName)
+{
+    FILE *file = fopen(fileName, "w");
+    long long dropped = 0;
+    if (file != NULL)
+    {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        int separator = 0;
+        for (int slot = 0; slot <= MAXIMAL_THREADS; slot++)
+        {
+            const TraceBuffer *buffer = &traceBuffers[slot];
+            if (buffer->events == NULL)
+            {
+                continue;
+            }
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"%s %d\"}}", separator ? ",\n" : "", slot,
+                    slot == 0 ? "main" : "worker", slot);
+            separator = 1;
+            long long first = buffer->count > TRACE_BUFFER_EVENTS ?
+                              buffer->count - TRACE_BUFFER_EVENTS : 0;
+            dropped += first;
+            for (long long index = first; index < buffer->count; index++)
+            {
+                const TraceEvent *event = &buffer->events[index % TRACE_BUFFER_EVENTS];
+                // complete events rather than begin and end pairs, which the ring could split
+                fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"02n\",\"ph\":\"X\",\"pid\":1,"
+                        "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", event->name, slot,
+                        (event->begin - traceStart) / NANOSECONDS_IN_MICROSECOND,
+                        (event->end - event->begin) / NANOSECONDS_IN_MICROSECOND);
+                if (event->first >= 0)
+                {
+                    fprintf(file, ",\"args\":{\"first\":%d,\"second\":%d}", event->first,
+                            event->second);
+                }
+                fputc('}', file);
+            }
+        }
+        fprintf(file, "\n]}\n");
+    }
+    for (int slot = 0; slot <= MAXIMAL_THREADS; slot++)
+    {
+        free(traceBuffers[slot].events);
+    }
+    free(traceBuffers);
+    traceBuffers = NULL;
+    if (dropped > 0)
+    {
+        fprintf(stderr, "Trace: the %lld oldest events were overwritten\n", dropped);
+    }
+    return file != NULL && fclose(file) == 0 ? 0 : -1;
+}
+
+long long markPhase(ComparisonContext *context, int phase, long long mark)
+{
+    if (context->pairStatistics == NULL)
+    {
+        return 0;
+    }
+    long long now = getTimeNanoseconds();
+    if (phase != PHASE_NONE)
+    {
+        context->phaseTimes[phase] += now - mark;
+    }
+    return now;
+}
+
+void recordPairStatistics(ComparisonContext *context, int first, int second,
+                          long long nanoseconds, const char *kernel)
+{
+    PairStatistics *statistics =
+        &context->pairStatistics[(size_t)first * context->numberOfSequences + second];
+    statistics->nanoseconds = nanoseconds;
+    statistics->source = PAIR_SOURCE_COMPUTED;
+    if (kernel != NULL)
+    {
+        snprintf(statistics->kernel, sizeof(statistics->kernel), "%s", kernel);
+    }
+    else if (context->options->anchored)
+    {
+        strcpy(statistics->kernel, "anchored");
+    }
+    else if (context->options->autoTune)
+    {
+        long long cells = (long long)context->lengths[first] * context->lengths[second];
+        getEngineName(context->planEngines[getPairBucket(cells)], statistics->kernel);
+    }
+    else if (context->options->memoryLimit > 0)
+    {
+        snprintf(statistics->kernel, sizeof(statistics->kernel), "%s",
+                 STRATEGY_NAMES[planPair(context, first, second, 0)]);
+    }
+    else
+    {
+        getEngineName(profileEngine, statistics->kernel);
+    }
+}
+
+int writeStatistics(const ComparisonContext *context, const char *fileName)
+{
+    fprintf(stderr, "Stats:");
+    for (int phase = 0; phase < PHASES_COUNT; phase++)
+    {
+        fprintf(stderr, "%s %s %.3f ms", phase > 0 ? "," : "", PHASE_NAMES[phase],
+                context->phaseTimes[phase] / NANOSECONDS_IN_MILLISECOND);
+    }
+    fprintf(stderr, "\n");
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    // the phases come first as a comment, so CSV readers skipping comments see only the pairs
+    fprintf(file, "# phases (ns):");
+    for (int phase = 0; phase < PHASES_COUNT; phase++)
+    {
+        fprintf(file, " %s %lld", PHASE_NAMES[phase], context->phaseTimes[phase]);
+    }
+    fprintf(file, "\nfirst,second,length1,length2,cells,kernel,precision,pruned,source,"
+            "nanoseconds\n");
+    int n = context->numberOfSequences;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            const PairStatistics *statistics = &context->pairStatistics[(size_t)i * n + j];
+            // the pairs of the other shards
+            if (statistics->source == PAIR_SOURCE_NONE)
+            {
+                continue;
+            }
+            writeCsvField(file, context->sequencesNames[i]);
+            fputc(',', file);
+            writeCsvField(file, context->sequencesNames[j]);
+            fprintf(file, ",%d,%d,%lld,", context->lengths[i], context->lengths[j],
+                    (long long)context->lengths[i] * context->lengths[j]);
+            writeCsvField(file, statistics->kernel);
+            fprintf(file, ",%s,%d,%s,%lld\n", PRECISION_TIER,
+                    statistics->source == PAIR_SOURCE_PRUNED,
+                    PAIR_SOURCE_NAMES[(int)statistics->source], statistics->nanoseconds);
+        }
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+void writeCsvField(FILE *file, const char *field)
+{
+    if (strpbrk(field, ",\"\n") == NULL)
+    {
+        fputs(field, file);
+        return;
+    }
+    fputc('"', file);
+    for (const char *character = field; *character != '\0'; character++)
+    {
+        if (*character == '"')
+        {
+            fputc('"', file);
+        }
+        fputc(*character, file);
+    }
+    fputc('"', file);
+}
+
+void startProgress(ComparisonContext *context, const int *sharedSeeds)
+{
+    int n = context->numberOfSequences;
+    void *counters = NULL;
+    if (posix_memalign(&counters, CACHE_LINE_BYTES,
+                       (MAXIMAL_THREADS + 1) * sizeof(ProgressCounter)) != 0)
+    {
+        fprintf(stderr, "Progress: not reported, the memory allocation failed\n");
+        return;
+    }
+    context->progress = (ProgressCounter *)counters;
+    memset(context->progress, 0, (MAXIMAL_THREADS + 1) * sizeof(ProgressCounter));
+    context->progressTotalPairs = 0;
+    context->progressTotalCells = 0;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            if (isScheduledPair(context, sharedSeeds, i, j))
+            {
+                context->progressTotalPairs++;
+                context->progressTotalCells += (long long)context->lengths[i] * context->lengths[j];
+            }
+        }
+    }
+    // the pairs scored by a tiled or parallel pass are counted there, and not again when printed
+    context->progressOnPrint = !((context->options->tiled && !context->options->anchored) ||
+                                 context->options->threads > 1);
+    context->progressStart = getTimeNanoseconds();
+    context->progressLastTime = context->progressStart;
+    context->progressLastCells = 0;
+    context->progressStopped = 0;
+    pthread_cond_init(&context->progressStop, NULL);
+    if (pthread_create(&context->progressThread, NULL, reportProgressPeriodically, context) != 0)
+    {
+        free(context->progress);
+        context->progress = NULL;
+    }
+}
+
+void stopProgress(ComparisonContext *context)
+{
+    pthread_mutex_lock(&context->lock);
+    context->progressStopped = 1;
+    pthread_cond_signal(&context->progressStop);
+    pthread_mutex_unlock(&context->lock);
+    pthread_join(context->progressThread, NULL);
+    reportProgress(context);
+    free(context->progress);
+    context->progress = NULL;
+}
+
+void *reportProgressPeriodically(void *argument)
+{
+    ComparisonContext *context = (ComparisonContext *)argument;
+    pthread_mutex_lock(&context->lock);
+    while (!context->progressStopped)
+    {
+        struct timespec wakeTime;
+        clock_gettime(CLOCK_REALTIME, &wakeTime);
+        long long nanoseconds = wakeTime.tv_nsec + PROGRESS_INTERVAL_NANOSECONDS;
+        wakeTime.tv_sec += (time_t)(nanoseconds / NANOSECONDS_IN_SECOND);
+        wakeTime.tv_nsec = (long)(nanoseconds % NANOSECONDS_IN_SECOND);
+        if (pthread_cond_timedwait(&context->progressStop, &context->lock, &wakeTime) != 0 &&
+            !context->progressStopped)
+        {
+            pthread_mutex_unlock(&context->lock);
+            reportProgress(context);
+            pthread_mutex_lock(&context->lock);
+        }
+    }
+    pthread_mutex_unlock(&context->lock);
+    return NULL;
+}
+
+void reportProgress(ComparisonContext *context)
+{
+    long long pairs = 0, cells = 0, computedCells = 0;
+    for (int slot = 0; slot <= MAXIMAL_THREADS; slot++)
+    {
+        pairs += __atomic_load_n(&context->progress[slot].pairs, __ATOMIC_RELAXED);
+        cells += __atomic_load_n(&context->progress[slot].cells, __ATOMIC_RELAXED);
+        computedCells += __atomic_load_n(&context->progress[slot].computedCells, __ATOMIC_RELAXED);
+    }
+    long long now = getTimeNanoseconds();
+    double interval = (double)(now - context->progressLastTime) / NANOSECONDS_IN_SECOND;
+    double elapsed = (double)(now - context->progressStart) / NANOSECONDS_IN_SECOND;
+    double gcups = interval > 0 ? (computedCells - context->progressLastCells) / interval /
+                                  CELLS_IN_GIGACELL : 0;
+    // the time left follows the cells left, as the pairs of a run can differ a lot in size
+    double eta = cells > 0 ? elapsed * (double)(context->progressTotalCells - cells) / cells : 0;
+    context->progressLastTime = now;
+    context->progressLastCells = computedCells;
+    char status[JOURNAL_LINE_LENGTH * 2];
+    snprintf(status, sizeof(status), "Progress: %lld of %lld pairs (%.1f%%), %lld of %lld cells, "
+             "%.3f GCUPS, %.1f s elapsed, ETA %.1f s\n", pairs, context->progressTotalPairs,
+             context->progressTotalPairs ? PERCENT * pairs / context->progressTotalPairs : PERCENT,
+             cells, context->progressTotalCells, gcups, elapsed, eta);
+    const char *fileName = context->options->progressFileName;
+    if (fileName == NULL)
+    {
+        fputs(status, stderr);
+        return;
+    }
+    // the status file is replaced at once, so a reader never sees half of it
+    char temporaryName[PATH_MAX];
+    snprintf(temporaryName, sizeof(temporaryName), "%s.tmp", fileName);
+    FILE *file = fopen(temporaryName, "w");
+    if (file != NULL)
+    {
+        fputs(status, file);
+        fclose(file);
+        rename(temporaryName, fileName);
+    }
+}
+
+void countProgress(ComparisonContext *context, long long pairs, long long cells,
+                   long long computedCells)
+{
+    if (context->progress == NULL)
+    {
+        return;
+    }
+    ProgressCounter *counter = &context->progress[threadSlot];
+    __atomic_store_n(&counter->pairs, counter->pairs + pairs, __ATOMIC_RELAXED);
+    __atomic_store_n(&counter->cells, counter->cells + cells, __ATOMIC_RELAXED);
+    __atomic_store_n(&counter->computedCells, counter->computedCells + computedCells,
+                     __ATOMIC_RELAXED);
+}
+
+void scorePairsParallel(ComparisonContext *context, const int *sharedSeeds)
+{
+    int n = context->numberOfSequences;
+    ParallelScoring scoring;
+    scoring.context = context;
+    scoring.pairsCount = 0;
+    scoring.nextPair = 0;
+    scoring.threadsStarted = 0;
+    scoring.pairs = (int (*)[2])malloc(((size_t)n * n / 2 + 1) * sizeof(int[2]));
+    pthread_t *threads = (pthread_t *)malloc(context->options->threads * sizeof(pthread_t));
+    if (scoring.pairs == NULL || threads == NULL)
+    {
+        // the pairs are scored as they are printed
+        free(scoring.pairs);
+        free(threads);
+        return;
+    }
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            if (isScheduledPair(context, sharedSeeds, i, j))
+            {
+                scoring.pairs[scoring.pairsCount][0] = i;
+                scoring.pairs[scoring.pairsCount++][1] = j;
+            }
+        }
+    }
+    int threadsCount = 0;
+    while (threadsCount < context->options->threads &&
+           pthread_create(&threads[threadsCount], NULL, scorePairsWorker, &scoring) == 0)
+    {
+        threadsCount++;
+    }
+    for (int thread = 0; thread < threadsCount; thread++)
+    {
+        pthread_join(threads[thread], NULL);
+    }
+    free(scoring.pairs);
+    free(threads);
+    context->pairsJournaled = 1;
+    if (workerFailed)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, context->numberOfSequences);
+        freeSequencesMemory(context->sequences, context->numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void *scorePairsWorker(void *argument)
+{
+    ParallelScoring *scoring = (ParallelScoring *)argument;
+    ComparisonContext *context = scoring->context;
+    pthread_mutex_lock(&context->lock);
+    // the worker threads take the slots after the main thread's, in the order they start
+    threadSlot = ++scoring->threadsStarted;
+    pthread_mutex_unlock(&context->lock);
+    while (1)
+    {
+        long long waitBegin = beginTrace();
+        pthread_mutex_lock(&context->lock);
+        int pair = scoring->nextPair < scoring->pairsCount ? scoring->nextPair++ : -1;
+        pthread_mutex_unlock(&context->lock);
+        endTrace("queue wait", waitBegin, -1, -1);
+        if (pair < 0 || __atomic_load_n(&workerFailed, __ATOMIC_RELAXED))
+        {
+            return NULL;
+        }
+        int first = scoring->pairs[pair][0], second = scoring->pairs[pair][1];
+        int score = scorePair(context, first, second);
+        journalPairScore(context, first, second, score, 1);
+        countProgress(context, 1, (long long)context->lengths[first] * context->lengths[second], 0);
+    }
+}
+
+int startExtensibleAlignment(ExtensibleAlignment *alignment, const char *sequence2, int length2,
+                             int m, int s, int g)
+{
+    alignment->sequence2 = sequence2;
+    alignment->length2 = length2;
+    alignment->m = m;
+    alignment->s = s;
+    alignment->g = g;
+    alignment->length1 = 0;
+    alignment->row = (int *)malloc((length2 + 1) * sizeof(int));
+    if (alignment->row == NULL)
+    {
+        return -1;
+    }
+    for (int j = 0; j <= length2; j++)
+    {
+        alignment->row[j] = j * g;
+    }
+    return 0;
+}
+
+int extendAlignment(ExtensibleAlignment *alignment, const char *residues, int count)
+{
+    advanceRollingRow(alignment->row, alignment->length1, residues, count, alignment->sequence2,
+                      alignment->length2, alignment->m, alignment->s, alignment->g);
+    alignment->length1 += count;
+    return alignment->row[alignment->length2];
+}
+
+void freeExtensibleAlignment(ExtensibleAlignment *alignment)
+{
+    free(alignment->row);
+    alignment->row = NULL;
+}
+
+void streamExtensions(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g)
+{
+    ExtensibleAlignment alignments[MAXIMAL_NUMBER_OF_SEQUENCES];
+    char *line = NULL, *name = NULL;
+    size_t lineCapacity = 0;
+    // whether a sequence is being extended, and the number of its alignments started
+    int started = 0, startedCount = 0, failed = 0;
+    ssize_t lineLength;
+    while (!failed && (lineLength = getline(&line, &lineCapacity, stdin)) > 0)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == HEADER_LINE_FIRST_CHAR || !started)
+        {
+            for (int i = 0; i < startedCount; i++)
+            {
+                freeExtensibleAlignment(&alignments[i]);
+            }
+            free(name);
+            name = (char *)malloc(strlen(line) + 1);
+            failed = name == NULL;
+            startedCount = 0;
+            while (!failed && startedCount < numberOfSequences)
+            {
+                failed = startExtensibleAlignment(&alignments[startedCount],
+                                                  sequences[startedCount],
+                                                  (int)strlen(sequences[startedCount]), m, s, g);
+                startedCount += !failed;
+            }
+            if (failed)
+            {
+                break;
+            }
+            started = 1;
+            // residues before the first header belong to an unnamed sequence
+            strcpy(name, line[0] == HEADER_LINE_FIRST_CHAR ? line + 1 : "");
+            if (line[0] == HEADER_LINE_FIRST_CHAR)
+            {
+                continue;
+            }
+        }
+        int count = (int)strlen(line);
+        for (int i = 0; i < numberOfSequences; i++)
+        {
+            printScore(extendAlignment(&alignments[i], line, count), name, sequencesNames[i]);
+        }
+        fflush(stdout);
+    }
+    for (int i = 0; i < startedCount; i++)
+    {
+        freeExtensibleAlignment(&alignments[i]);
+    }
+    free(name);
+    free(line);
+    if (failed)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void serveScores(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                 int m, int s, int g, const ProgramOptions *options)
+{
+    static ScoreServer server;
+    static ServerWorker workers[MAXIMAL_THREADS];
+    // the workers score with the kernel chosen at startup
+    const char *isaName = PROFILE_KERNEL_VARIANTS[profileEngine - ENGINE_FIRST_PROFILE].name;
+    int maximalLength = 0, workersCount = 0, threadsCount = 0;
+    server.databaseCount = numberOfSequences;
+    for (int i = 0; i < numberOfSequences; i++)
+    {
+        server.database[i].residues = sequences[i];
+        server.database[i].length = (int)strlen(sequences[i]);
+        maximalLength = max(maximalLength, server.database[i].length);
+    }
+    for (int i = 0; i < SERVE_MAXIMAL_CONNECTIONS; i++)
+    {
+        server.connections[i].socket = -1;
+    }
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.queued, NULL);
+    int failed = buildServerGreeting(&server, sequencesNames);
+    for (; !failed && workersCount < options->threads; workersCount++)
+    {
+        ServerWorker *worker = &workers[workersCount];
+        worker->server = &server;
+        worker->aligner = NULL;
+        worker->pairs = (SequencePair *)trackedMalloc(((size_t)numberOfSequences + 1) *
+                                                      sizeof(SequencePair), MEMORY_WORKSPACE);
+        worker->scores = (int *)trackedMalloc(((size_t)numberOfSequences + 1) * sizeof(int),
+                                              MEMORY_WORKSPACE);
+        failed = worker->pairs == NULL || worker->scores == NULL ||
+                 createSequencesAligner(m, s, g, isaName, maximalLength, &worker->aligner) !=
+                 ALIGNER_SUCCESS;
+        for (int i = 0; !failed && i < numberOfSequences; i++)
+        {
+            worker->pairs[i].second = server.database[i];
+        }
+    }
+    int listener = -1;
+    if (failed || pipe(server.wakePipe))
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+    }
+    else if ((listener = openServerSocket(options->serveSocketName)) < 0)
+    {
+        fprintf(stderr, "Error - can't listen on %s\n", options->serveSocketName);
+        close(server.wakePipe[0]);
+        close(server.wakePipe[1]);
+    }
+    else
+    {
+        servingWakeDescriptor = server.wakePipe[1];
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stopServing;
+    sigemptyset(&action.sa_mask);
+    while (listener >= 0 && threadsCount < workersCount &&
+           pthread_create(&workers[threadsCount].thread, NULL, serveScoresWorker,
+                          &workers[threadsCount]) == 0)
+    {
+        threadsCount++;
+    }
+    if (listener >= 0 && threadsCount > 0 && sigaction(SIGINT, &action, NULL) == 0 &&
+        sigaction(SIGTERM, &action, NULL) == 0)
+    {
+        fprintf(stderr, "Serve: %d sequences on %s, %d threads\n", numberOfSequences,
+                options->serveSocketName, threadsCount);
+    }
+    else
+    {
+        if (listener >= 0)
+        {
+            fprintf(stderr, "Error - can't start the server threads\n");
+        }
+        servingStopped = 1;
+        failed = 1;
+    }
+    struct pollfd polled[SERVE_MAXIMAL_CONNECTIONS + 2];
+    int polledClients[SERVE_MAXIMAL_CONNECTIONS + 2];
+    char wake[SERVE_MAXIMAL_CONNECTIONS];
+    while (!servingStopped)
+    {
+        int polledCount = 2, clientsCount = 0;
+        pthread_mutex_lock(&server.lock);
+        for (int i = 0; i < SERVE_MAXIMAL_CONNECTIONS; i++)
+        {
+            // a client whose query is being answered isn't read until the answer is sent
+            ServerConnection *connection = &server.connections[i];
+            if (connection->socket >= 0 && !connection->busy)
+            {
+                polled[polledCount].fd = connection->socket;
+                polled[polledCount].events = connection->outputSent < connection->outputBytes ?
+                                             POLLOUT : POLLIN;
+                polledClients[polledCount++] = i;
+            }
+            clientsCount += connection->socket >= 0;
+        }
+        pthread_mutex_unlock(&server.lock);
+        polled[0].fd = server.wakePipe[0];
+        polled[0].events = POLLIN;
+        // a full server leaves the new clients in the backlog
+        polled[1].fd = clientsCount < SERVE_MAXIMAL_CONNECTIONS ? listener : -1;
+        polled[1].events = POLLIN;
+        if (poll(polled, (nfds_t)polledCount, -1) < 0 ||
+            ((polled[0].revents & POLLIN) && read(server.wakePipe[0], wake, sizeof(wake)) < 0))
+        {
+            continue;
+        }
+        if (polled[1].revents & POLLIN)
+        {
+            acceptServerClient(&server, listener);
+        }
+        for (int i = 2; i < polledCount; i++)
+        {
+            ServerConnection *connection = &server.connections[polledClients[i]];
+            int request = 0;
+            if (polled[i].revents && polled[i].events == POLLOUT)
+            {
+                request = sendServerOutput(connection);
+            }
+            else if (polled[i].revents)
+            {
+                request = readServerRequest(connection);
+            }
+            if (request < 0)
+            {
+                closeServerClient(connection);
+            }
+            else if (request > 0)
+            {
+                pthread_mutex_lock(&server.lock);
+                connection->busy = 1;
+                server.queue[(server.queueHead + server.queueCount++) % SERVE_MAXIMAL_CONNECTIONS] =
+                    polledClients[i];
+                pthread_cond_signal(&server.queued);
+                pthread_mutex_unlock(&server.lock);
+            }
+        }
+    }
+    pthread_mutex_lock(&server.lock);
+    server.stopping = 1;
+    pthread_cond_broadcast(&server.queued);
+    pthread_mutex_unlock(&server.lock);
+    for (int thread = 0; thread < threadsCount; thread++)
+    {
+        pthread_join(workers[thread].thread, NULL);
+    }
+    for (int i = 0; i < SERVE_MAXIMAL_CONNECTIONS; i++)
+    {
+        if (server.connections[i].socket >= 0)
+        {
+            closeServerClient(&server.connections[i]);
+        }
+    }
+    if (listener >= 0)
+    {
+        close(listener);
+        unlink(options->serveSocketName);
+        close(server.wakePipe[0]);
+        close(server.wakePipe[1]);
+    }
+    servingWakeDescriptor = -1;
+    for (int worker = 0; worker < workersCount; worker++)
+    {
+        freeSequencesAligner(workers[worker].aligner);
+        trackedFree(workers[worker].pairs);
+        trackedFree(workers[worker].scores);
+    }
+    trackedFree(server.greeting);
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.queued);
+    if (failed)
+    {
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int openServerSocket(const char *path)
+{
+    struct sockaddr_un address;
+    struct stat status;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    // only a socket is replaced, never a file that happens to have the path
+    if (stat(path, &status) == 0 && S_ISSOCK(status.st_mode))
+    {
+        unlink(path);
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return -1;
+    }
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) ||
+        listen(listener, SERVE_BACKLOG))
+    {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+int buildServerGreeting(ScoreServer *server, char *sequencesNames[])
+{
+    size_t bytes = sizeof(uint32_t);
+    for (int i = 0; i < server->databaseCount; i++)
+    {
+        bytes += 2 * sizeof(uint32_t) + strlen(sequencesNames[i]);
+    }
+    server->greeting = (unsigned char *)trackedMalloc(bytes, MEMORY_OUTPUT);
+    if (server->greeting == NULL)
+    {
+        return -1;
+    }
+    uint32_t number = htonl((uint32_t)server->databaseCount);
+    memcpy(server->greeting, &number, sizeof(number));
+    server->greetingBytes = sizeof(number);
+    for (int i = 0; i < server->databaseCount; i++)
+    {
+        size_t nameLength = strlen(sequencesNames[i]);
+        number = htonl((uint32_t)nameLength);
+        memcpy(server->greeting + server->greetingBytes, &number, sizeof(number));
+        memcpy(server->greeting + server->greetingBytes + sizeof(number), sequencesNames[i],
+               nameLength);
+        server->greetingBytes += sizeof(number) + nameLength;
+        number = htonl((uint32_t)server->database[i].length);
+        memcpy(server->greeting + server->greetingBytes, &number, sizeof(number));
+        server->greetingBytes += sizeof(number);
+    }
+    return 0;
+}
+
+void acceptServerClient(ScoreServer *server, int listener)
+{
+    int client = accept(listener, NULL, NULL);
+    if (client < 0)
+    {
+        return;
+    }
+    for (int i = 0; i < SERVE_MAXIMAL_CONNECTIONS; i++)
+    {
+        ServerConnection *connection = &server->connections[i];
+        if (connection->socket < 0)
+        {
+            connection->socket = client;
+            connection->prefixBytes = 0;
+            connection->query = NULL;
+            connection->queryCapacity = 0;
+            connection->queryLength = 0;
+            connection->queryBytes = 0;
+            connection->busy = 0;
+            connection->response = (uint32_t *)trackedMalloc(
+                ((size_t)server->databaseCount + 1) * sizeof(uint32_t), MEMORY_OUTPUT);
+            connection->output = server->greeting;
+            connection->outputBytes = server->greetingBytes;
+            connection->outputSent = 0;
+            int flags = fcntl(client, F_GETFL);
+            if (connection->response == NULL || flags < 0 ||
+                fcntl(client, F_SETFL, flags | O_NONBLOCK) < 0)
+            {
+                closeServerClient(connection);
+            }
+            return;
+        }
+    }
+    close(client);
+}
+
+int readServerRequest(ServerConnection *connection)
+{
+    ssize_t bytes;
+    if (connection->prefixBytes < SERVE_PREFIX_BYTES)
+    {
+        bytes = read(connection->socket, connection->prefix + connection->prefixBytes,
+                     SERVE_PREFIX_BYTES - connection->prefixBytes);
+        if (bytes <= 0)
+        {
+            return bytes < 0 && errno == EINTR ? 0 : -1;
+        }
+        connection->prefixBytes += (int)bytes;
+        if (connection->prefixBytes < SERVE_PREFIX_BYTES)
+        {
+            return 0;
+        }
+        uint32_t length;
+        memcpy(&length, connection->prefix, sizeof(length));
+        length = ntohl(length);
+        if (length > SERVE_MAXIMAL_QUERY_LENGTH)
+        {
+            return -1;
+        }
+        if ((int)length > connection->queryCapacity)
+        {
+            char *query = (char *)trackedRealloc(connection->query, length, MEMORY_SEQUENCES);
+            if (query == NULL)
+            {
+                return -1;
+            }
+            connection->query = query;
+            connection->queryCapacity = (int)length;
+        }
+        connection->queryLength = (int)length;
+        connection->queryBytes = 0;
+    }
+    else
+    {
+        bytes = read(connection->socket, connection->query + connection->queryBytes,
+                     connection->queryLength - connection->queryBytes);
+        if (bytes <= 0)
+        {
+            return bytes < 0 && errno == EINTR ? 0 : -1;
+        }
+        connection->queryBytes += (int)bytes;
+    }
+    return connection->queryBytes == connection->queryLength;
+}
+
+int sendServerOutput(ServerConnection *connection)
+{
+    while (connection->outputSent < connection->outputBytes)
+    {
+        // a client that went away fails the send instead of raising SIGPIPE
+        ssize_t sent = send(connection->socket, connection->output + connection->outputSent,
+                            connection->outputBytes - connection->outputSent, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 0;
+        }
+        if (sent <= 0)
+        {
+            return -1;
+        }
+        connection->outputSent += (size_t)sent;
+    }
+    return 0;
+}
+
+void closeServerClient(ServerConnection *connection)
+{
+    close(connection->socket);
+    connection->socket = -1;
+    trackedFree(connection->query);
+    connection->query = NULL;
+    trackedFree(connection->response);
+    connection->response = NULL;
+}
+
+void *serveScoresWorker(void *argument)
+{
+    ServerWorker *worker = (ServerWorker *)argument;
+    ScoreServer *server = worker->server;
+    pthread_mutex_lock(&server->lock);
+    // the worker threads take the slots after the main thread's, in the order they start
+    threadSlot = ++server->threadsStarted;
+    while (1)
+    {
+        long long waitBegin = beginTrace();
+        while (!server->stopping && server->queueCount == 0)
+        {
+            pthread_cond_wait(&server->queued, &server->lock);
+        }
+        endTrace("queue wait", waitBegin, -1, -1);
+        if (server->stopping)
+        {
+            pthread_mutex_unlock(&server->lock);
+            return NULL;
+        }
+        ServerConnection *connection = &server->connections[server->queue[server->queueHead]];
+        server->queueHead = (server->queueHead + 1) % SERVE_MAXIMAL_CONNECTIONS;
+        server->queueCount--;
+        pthread_mutex_unlock(&server->lock);
+        long long queryBegin = beginTrace();
+        answerServerQuery(worker, connection);
+        endTrace("query", queryBegin, -1, -1);
+        pthread_mutex_lock(&server->lock);
+        connection->prefixBytes = 0;
+        connection->busy = 0;
+        // the main thread sends the response, and then reads the next request of the client
+        ssize_t written = write(server->wakePipe[1], "", 1);
+        (void)written;
+    }
+}
+
+void answerServerQuery(ServerWorker *worker, ServerConnection *connection)
+{
+    int count = worker->server->databaseCount;
+    SequenceSpan query = {connection->query, connection->queryLength};
+    for (int i = 0; i < count; i++)
+    {
+        worker->pairs[i].first = query;
+    }
+    int status = scoreSequencesPairs(worker->aligner, worker->pairs, count, worker->scores);
+    connection->response[0] = htonl((uint32_t)status);
+    count = status == ALIGNER_SUCCESS ? count : 0;
+    for (int i = 0; i < count; i++)
+    {
+        connection->response[i + 1] = htonl((uint32_t)worker->scores[i]);
+    }
+    connection->output = (const unsigned char *)connection->response;
+    connection->outputBytes = ((size_t)count + 1) * sizeof(uint32_t);
+    connection->outputSent = 0;
+}
+
+void stopServing(int signalNumber)
+{
+    (void)signalNumber;
+    servingStopped = 1;
+    // the main thread waits in poll, and wakes on the pipe whichever thread got the signal
+    if (servingWakeDescriptor >= 0)
+    {
+        ssize_t written = write(servingWakeDescriptor, "", 1);
+        (void)written;
+    }
+}
+
+int scoreAnchored(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                  char *sequence1, char *sequence2, int m, int s, int g, int kmerLength,
+                  int *anchorsCountAddress)
+{
+    int length1 = (int)strlen(sequence1), length2 = (int)strlen(sequence2);
+    uint64_t *kmerHashes1 = (uint64_t *)malloc((length1 + 1) * sizeof(uint64_t));
+    uint64_t *kmerHashes2 = (uint64_t *)malloc((length2 + 1) * sizeof(uint64_t));
+    KmerPosition *kmers2 = (KmerPosition *)malloc((length2 + 1) * sizeof(KmerPosition));
+    Anchor *anchors = (Anchor *)malloc((length1 + 1) * sizeof(Anchor));
+    long long *chainScores = (long long *)malloc((length1 + 1) * sizeof(long long));
+    int *predecessors = (int *)malloc((length1 + 1) * sizeof(int));
+    int *chain = (int *)malloc((length1 + 1) * sizeof(int));
+    int *row = (int *)malloc((length2 + 1) * sizeof(int));
+    int failed = kmerHashes1 == NULL || kmerHashes2 == NULL || kmers2 == NULL ||
+                 anchors == NULL || chainScores == NULL || predecessors == NULL || chain == NULL ||
+                 row == NULL;
+    if (failed && flagWorkerFailure())
+    {
+        free(kmerHashes1);
+        free(kmerHashes2);
+        free(kmers2);
+        free(anchors);
+        free(chainScores);
+        free(predecessors);
+        free(chain);
+        free(row);
+        return 0;
+    }
+    if (failed)
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        freeSequencesMemory(sequencesNames, numberOfSequences);
+        freeSequencesMemory(sequences, numberOfSequences);
+        exit(EXIT_FAILURE);
+    }
+    int kmersCount1 = hashKmers(sequence1, length1, kmerLength, kmerHashes1);
+    int kmersCount2 = hashKmers(sequence2, length2, kmerLength, kmerHashes2);
+    for (int i = 0; i < kmersCount2; i++)
+    {
+        kmers2[i].hash = kmerHashes2[i];
+        kmers2[i].position = i;
+    }
+    qsort(kmers2, (size_t)kmersCount2, sizeof(KmerPosition), compareKmerPositions);
+    int anchorsCount = findAnchors(sequence1, kmerHashes1, kmersCount1, sequence2, kmers2,
+                                   kmersCount2, kmerLength, anchors);
+    int chainLength = chainAnchors(anchors, anchorsCount, length1, length2, m, g, chainScores,
+                                   predecessors, chain);
+    // the anchors are aligned as exact matches, and every gap between them by the exact algorithm
+    int score = 0, end1 = 0, end2 = 0;
+    for (int i = 0; i <= chainLength; i++)
+    {
+        int start1 = i < chainLength ? anchors[chain[i]].position1 : length1;
+        int start2 = i < chainLength ? anchors[chain[i]].position2 : length2;
+        score += scoreWithRollingRow(sequence1 + end1, start1 - end1, sequence2 + end2,
+                                     start2 - end2, m, s, g, row);
+        if (i < chainLength)
+        {
+            score += anchors[chain[i]].length * m;
+            end1 = start1 + anchors[chain[i]].length;
+            end2 = start2 + anchors[chain[i]].length;
+        }
+    }
+    free(kmerHashes1);
+    free(kmerHashes2);
+    free(kmers2);
+    free(anchors);
+    free(chainScores);
+    free(predecessors);
+    free(chain);
+    free(row);
+    *anchorsCountAddress = chainLength;
+    return score;
+}
+
+int findAnchors(const char *sequence1, const uint64_t *kmerHashes1, int kmersCount1,
+                const char *sequence2, const KmerPosition *kmers2, int kmersCount2,
+                int kmerLength, Anchor *anchors)
+{
+    int anchorsCount = 0;
+    for (int i = 0; i < kmersCount1; i++)
+    {
+        int low = 0, high = kmersCount2;
+        while (low < high)
+        {
+            int middle = low + (high - low) / 2;
+            if (kmers2[middle].hash < kmerHashes1[i])
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        // only k-mers appearing once in sequence2 are anchors, repeats can't be placed reliably
+        if (low >= kmersCount2 || kmers2[low].hash != kmerHashes1[i] ||
+            (low + 1 < kmersCount2 && kmers2[low + 1].hash == kmerHashes1[i]))
+        {
+            continue;
+        }
+        int j = kmers2[low].position;
+        if (memcmp(sequence1 + i, sequence2 + j, (size_t)kmerLength) != 0)
+        {
+            continue;
+        }
+        Anchor *last = anchorsCount > 0 ? &anchors[anchorsCount - 1] : NULL;
+        if (last != NULL && j - i == last->position2 - last->position1 &&
+            i <= last->position1 + last->length)
+        {
+            last->length = i + kmerLength - last->position1;
+            continue;
+        }
+        anchors[anchorsCount].position1 = i;
+        anchors[anchorsCount].position2 = j;
+        anchors[anchorsCount].length = kmerLength;
+        anchorsCount++;
+    }
+    return anchorsCount;
+}
+
+int chainAnchors(const Anchor *anchors, int anchorsCount, int length1, int length2, int m, int g,
+                 long long *chainScores, int *predecessors, int *chain)
+{
+    int best = -1;
+    long long gapPenalty = g < 0 ? -(long long)g : (long long)g;
+    long long bestScore = -llabs((long long)length1 - length2) * gapPenalty;
+    for (int a = 0; a < anchorsCount; a++)
+    {
+        long long startShift = llabs((long long)anchors[a].position1 - anchors[a].position2);
+        chainScores[a] = (long long)anchors[a].length * m - startShift * gapPenalty;
+        predecessors[a] = -1;
+        int firstPredecessor = a > CHAINING_LOOKBACK ? a - CHAINING_LOOKBACK : 0;
+        for (int b = firstPredecessor; b < a; b++)
+        {
+            int distance1 = anchors[a].position1 - (anchors[b].position1 + anchors[b].length);
+            int distance2 = anchors[a].position2 - (anchors[b].position2 + anchors[b].length);
+            if (distance1 < 0 || distance2 < 0)
+            {
+                continue;
+            }
+            long long shift = distance1 > distance2 ? distance1 - distance2 : distance2 - distance1;
+            long long candidate = chainScores[b] + (long long)anchors[a].length * m -
+                                  shift * gapPenalty;
+            if (candidate > chainScores[a])
+            {
+                chainScores[a] = candidate;
+                predecessors[a] = b;
+            }
+        }
+        long long endShift = llabs((long long)(length1 - anchors[a].position1) -
+                                   (length2 - anchors[a].position2));
+        if (chainScores[a] - endShift * gapPenalty > bestScore)
+        {
+            bestScore = chainScores[a] - endShift * gapPenalty;
+            best = a;
+        }
+    }
+    int chainLength = 0;
+    for (int a = best; a >= 0; a = predecessors[a])
+    {
+        chainLength++;
+    }
+    int position = chainLength;
+    for (int a = best; a >= 0; a = predecessors[a])
+    {
+        chain[--position] = a;
+    }
+    return chainLength;
+}
+
+int compareKmerPositions(const void *first, const void *second)
+{
+    const KmerPosition *firstKmer = (const KmerPosition *)first;
+    const KmerPosition *secondKmer = (const KmerPosition *)second;
+    if (firstKmer->hash != secondKmer->hash)
+    {
+        return firstKmer->hash < secondKmer->hash ? -1 : 1;
+    }
+    return firstKmer->position - secondKmer->position;
+}
 
-/**
- * @brief The main function of the program. The function checks the validity of the usage of the
- * program, reads the sequences file, compares each pair of sequences in the file (using a dynamic
- * programming algorithm), and prints the score and the match for each pair.
- * @param argc The number of program arguments.
- * @param argv The program arguments.
- * @return 0 if the function succeed, -1 else.
- */
-int main(int argc, char *argv[])
+int alignPair(ComparisonContext *context, int first, int second)
 {
-    char *fileName = NULL;
-    int m, s, g;
-    int usage = checkUsage(argc, argv, &fileName, &m, &s, &g);
-    if (usage) // if the usage is wrong
+    char *sequence1 = context->sequences[first], *sequence2 = context->sequences[second];
+    int m = context->m, s = context->s, g = context->g;
+    if (!context->options->anchored && context->options->autoTune)
     {
-        fprintf(stdout, "Usage: CompareSequences <path_to_sequences_file> <m> <s> <g>\n");
-        return -1;
+        long long cells = (long long)context->lengths[first] * context->lengths[second];
+        return scoreWithEngine(context, context->planEngines[getPairBucket(cells)], first, second);
     }
-    char *sequencesNames[MAXIMAL_NUMBER_OF_SEQUENCES];
-    char *sequences[MAXIMAL_NUMBER_OF_SEQUENCES];
-    int numberOfSequences = 0;
-    readSequencesFile(fileName, sequencesNames, sequences, &numberOfSequences);
-    if (numberOfSequences < MINIMAL_NUMBER_OF_SEQUENCES)
+    if (!context->options->anchored && context->options->memoryLimit > 0)
     {
-        fprintf(stderr, "Error - the sequences file contains less than 2 sequences\n");
-        freeSequencesMemory(sequencesNames, numberOfSequences);
-        freeSequencesMemory(sequences, numberOfSequences);
+        return scoreWithinMemoryLimit(context, first, second);
     }
-    compareSequences(sequencesNames, sequences, numberOfSequences, m, s, g);
-    freeSequencesMemory(sequencesNames, numberOfSequences);
-    freeSequencesMemory(sequences, numberOfSequences);
-    return 0;
+    // the exact score runs on the profile kernel dispatched for the CPU, not on the baseline ISA
+    if (!context->options->anchored)
+    {
+        return scoreWithEngine(context, profileEngine, first, second);
+    }
+    int anchorsCount = 0;
+    int score = scoreAnchored(context->sequencesNames, context->sequences,
+                              context->numberOfSequences, sequence1, sequence2, m, s, g,
+                              context->options->kmerLength, &anchorsCount);
+    if (context->options->anchoredCheck)
+    {
+        int exactScore = scoreTwoSequences(context->sequencesNames, context->sequences,
+                                           context->numberOfSequences, sequence1, sequence2,
+                                           m, s, g);
+        fprintf(stderr, "Anchored check for %s to %s: anchored %d, exact %d, difference %d "
+                "(%d anchors)\n", context->sequencesNames[first], context->sequencesNames[second],
+                score, exactScore, exactScore - score, anchorsCount);
+    }
+    return score;
 }
 
-int checkUsage(int argc, char *argv[], char **fileNameAddress,
-               int *mAddress, int *sAddress, int *gAddress)
+void collectBucketSamples(const ComparisonContext *context,
+                          int samples[AUTO_BUCKETS][AUTO_SAMPLES_PER_BUCKET][2],
+                          int samplesCount[AUTO_BUCKETS])
 {
-    if (argc != NUMBER_OF_ARGUMENTS)
+    int n = context->numberOfSequences;
+    for (int i = 0; i < n - 1; i++)
     {
-        return -1;
+        for (int j = i + 1; j < n; j++)
+        {
+            int bucket = getPairBucket((long long)context->lengths[i] * context->lengths[j]);
+            if (samplesCount[bucket] < AUTO_SAMPLES_PER_BUCKET)
+            {
+                samples[bucket][samplesCount[bucket]][0] = i;
+                samples[bucket][samplesCount[bucket]][1] = j;
+                samplesCount[bucket]++;
+            }
+        }
     }
-    *fileNameAddress = argv[FILE_NAME_INDEX];
-    if (checkNumber(argv[M_INDEX], mAddress) ||
-        checkNumber(argv[S_INDEX], sAddress) ||
-        checkNumber(argv[G_INDEX], gAddress))
+}
+
+void benchmarkEngines(char *sequencesNames[], char *sequences[], int numberOfSequences,
+                      int m, int s, int g, const ProgramOptions *options)
+{
+    ComparisonContext context;
+    initializeComparisonContext(&context, sequencesNames, sequences, numberOfSequences, m, s, g,
+                                options);
+    int enginesCount = getEnginesCount();
+    int samples[AUTO_BUCKETS][AUTO_SAMPLES_PER_BUCKET][2];
+    int samplesCount[AUTO_BUCKETS] = {0};
+    collectBucketSamples(&context, samples, samplesCount);
+    PerfCounters counters;
+    if (openPerfCounters(&counters, 0) < PERF_COUNTERS_COUNT)
     {
-        return -1;
+        fprintf(stderr, "Bench: some hardware counters are not available (%s)\n",
+                strerror(counters.error));
     }
-    return 0;
+    printf("engine,bucket cells,pairs,repetitions,ns/cell,cycles/cell,IPC,L1d misses/kcell,"
+           "LLC misses/kcell,branch misses/kcell\n");
+    char name[MAXIMAL_ENGINE_NAME_LENGTH];
+    long long bucketCells = AUTO_FIRST_BUCKET_CELLS;
+    for (int bucket = 0; bucket < AUTO_BUCKETS; bucket++, bucketCells *= AUTO_BUCKET_FACTOR)
+    {
+        long long cells = 0;
+        for (int sample = 0; sample < samplesCount[bucket]; sample++)
+        {
+            cells += (long long)context.lengths[samples[bucket][sample][0]] *
+                     context.lengths[samples[bucket][sample][1]];
+        }
+        for (int engine = 0; samplesCount[bucket] > 0 && engine < enginesCount; engine++)
+        {
+            memset(counters.values, 0, sizeof(counters.values));
+            int repetitions = 0;
+            long long start = getTimeNanoseconds(), time = 0;
+            // the small buckets are repeated, so their times aren't lost in the timer's resolution
+            while (time < BENCH_MINIMAL_NANOSECONDS && repetitions < BENCH_MAXIMAL_REPETITIONS)
+            {
+                startPerfCounters(&counters);
+                for (int sample = 0; sample < samplesCount[bucket]; sample++)
+                {
+                    scoreWithEngine(&context, engine, samples[bucket][sample][0],
+                                    samples[bucket][sample][1]);
+                }
+                stopPerfCounters(&counters);
+                repetitions++;
+                time = getTimeNanoseconds() - start;
+            }
+            getEngineName(engine, name);
+            printf("%s,%s%lld,%d,%d,%.3f,", name, bucket < AUTO_BUCKETS - 1 ? "<" : ">=",
+                   bucket < AUTO_BUCKETS - 1 ? bucketCells : bucketCells / AUTO_BUCKET_FACTOR,
+                   samplesCount[bucket], repetitions, (double)time / (cells * repetitions));
+            printPerfCounters(stdout, &counters, cells * repetitions);
+        }
+    }
+    closePerfCounters(&counters);
+    freeComparisonContext(&context);
+}
 
+int openPerfCounters(PerfCounters *counters, int inherit)
+{
+    int opened = 0;
+    counters->error = 0;
+    memset(counters->values, 0, sizeof(counters->values));
+#if PERF_COUNTERS_SUPPORTED
+    const uint32_t types[PERF_COUNTERS_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                 PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+                                                 PERF_TYPE_HARDWARE};
+    const uint64_t configs[PERF_COUNTERS_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int counter = 0; counter < PERF_COUNTERS_COUNT; counter++)
+    {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[counter];
+        attributes.config = configs[counter];
+        attributes.disabled = 1;
+        attributes.inherit = (uint64_t)inherit;
+        // counting only the user space is allowed at the default paranoia level
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->descriptors[counter] = (int)syscall(SYS_perf_event_open, &attributes, 0, -1,
+                                                      -1, 0);
+        if (counters->descriptors[counter] < 0 && counters->error == 0)
+        {
+            counters->error = errno;
+        }
+        opened += counters->descriptors[counter] >= 0;
+    }
+#else
+    for (int counter = 0; counter < PERF_COUNTERS_COUNT; counter++)
+    {
+        counters->descriptors[counter] = -1;
+    }
+    counters->error = ENOSYS;
+#endif
+    return opened;
 }
 
-int checkNumber(char *str, int *numberAddress)
+void startPerfCounters(PerfCounters *counters)
 {
-    char *end = NULL;
-    *numberAddress = (int)strtol(str, &end, DECIMAL_BASE);
-    if ((*numberAddress == 0 && (errno != 0 || end == str)) || *end != '\0')
+#if PERF_COUNTERS_SUPPORTED
+    for (int counter = 0; counter < PERF_COUNTERS_COUNT; counter++)
     {
-        return -1;
+        if (counters->descriptors[counter] >= 0)
+        {
+            ioctl(counters->descriptors[counter], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->descriptors[counter], PERF_EVENT_IOC_ENABLE, 0);
+        }
     }
-    return 0;
+#else
+    (void)counters;
+#endif
 }
 
-void readSequencesFile(char *fileName, char *sequencesNames[], char *sequences[],
-                       int *numberOfSequencesAddress)
+void stopPerfCounters(PerfCounters *counters)
 {
-    FILE *file = fopen(fileName, "r");
-    if (file == NULL)
+#if PERF_COUNTERS_SUPPORTED
+    for (int counter = 0; counter < PERF_COUNTERS_COUNT; counter++)
     {
-        fprintf(stderr, "Error opening file\n");
-        exit(EXIT_FAILURE);
+        if (counters->descriptors[counter] < 0)
+        {
+            continue;
+        }
+        ioctl(counters->descriptors[counter], PERF_EVENT_IOC_DISABLE, 0);
+        // the value, the time enabled and the time running
+        uint64_t reading[3];
+        if (read(counters->descriptors[counter], reading, sizeof(reading)) ==
+            (ssize_t)sizeof(reading) && reading[2] > 0)
+        {
+            // a counter sharing the hardware with others only ran part of the time
+            counters->values[counter] += (long long)((double)reading[0] * reading[1] / reading[2]);
+        }
     }
-    char row[MAXIMAL_ROW_LENGTH];
-    int startSequence = 0;
-    int rowLength = 0;
-    int sequenceLength = 0;
-    char *temp = NULL;
-    while(fgets(row, MAXIMAL_ROW_LENGTH, file) != NULL)
+#else
+    (void)counters;
+#endif
+}
+
+void closePerfCounters(PerfCounters *counters)
+{
+    for (int counter = 0; counter < PERF_COUNTERS_COUNT; counter++)
     {
-        //when malloc add 1 to numberOfSequences
-        if (row[0] == HEADER_LINE_FIRST_CHAR)
+        if (counters->descriptors[counter] >= 0)
         {
-            rowLength = deleteNewline(row);
-            sequencesNames[*numberOfSequencesAddress] = (char *)malloc(rowLength * sizeof(char));
-            if (sequencesNames[*numberOfSequencesAddress] == NULL)
+            close(counters->descriptors[counter]);
+            counters->descriptors[counter] = -1;
+        }
+    }
+}
+
+void printPerfCounters(FILE *file, const PerfCounters *counters, long long cells)
+{
+    const int *descriptors = counters->descriptors;
+    const long long *values = counters->values;
+    if (descriptors[PERF_CYCLES] >= 0 && cells > 0)
+    {
+        fprintf(file, "%.3f,", (double)values[PERF_CYCLES] / cells);
+    }
+    else
+    {
+        fprintf(file, "n/a,");
+    }
+    if (descriptors[PERF_CYCLES] >= 0 && descriptors[PERF_INSTRUCTIONS] >= 0 &&
+        values[PERF_CYCLES] > 0)
+    {
+        fprintf(file, "%.2f", (double)values[PERF_INSTRUCTIONS] / values[PERF_CYCLES]);
+    }
+    else
+    {
+        fprintf(file, "n/a");
+    }
+    for (int counter = PERF_L1_MISSES; counter <= PERF_BRANCH_MISSES; counter++)
+    {
+        if (descriptors[counter] >= 0 && cells > 0)
+        {
+            fprintf(file, ",%.3f", values[counter] * CELLS_IN_KILOCELL / cells);
+        }
+        else
+        {
+            fprintf(file, ",n/a");
+        }
+    }
+    fprintf(file, "\n");
+}
+
+void planEngines(ComparisonContext *context)
+{
+    const char *fileName = context->options->planFileName;
+    if (fileName != NULL && loadEnginesPlan(context, fileName) == 0)
+    {
+        fprintf(stderr, "Auto: loaded the engines plan from %s\n", fileName);
+        return;
+    }
+    int enginesCount = getEnginesCount();
+    int samples[AUTO_BUCKETS][AUTO_SAMPLES_PER_BUCKET][2];
+    int samplesCount[AUTO_BUCKETS] = {0};
+    collectBucketSamples(context, samples, samplesCount);
+    int calibrated[AUTO_BUCKETS] = {0};
+    for (int bucket = 0; bucket < AUTO_BUCKETS; bucket++)
+    {
+        if (samplesCount[bucket] == 0)
+        {
+            continue;
+        }
+        long long bucketStart = getTimeNanoseconds(), bestTime = 0, bestFirstTime = 0;
+        int count = samplesCount[bucket], scored = 0, bestEngine = 0, bestFirstEngine = 0;
+        for (int engine = 0; engine < enginesCount; engine++)
+        {
+            long long start = getTimeNanoseconds(), firstTime = 0;
+            int sample = 0;
+            for (; sample < count; sample++)
             {
-                fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
-                freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
-                freeSequencesMemory(sequences, *numberOfSequencesAddress);
-                exit(EXIT_FAILURE);
+                // past the first sample of every engine, the rest of the bucket is projected from
+                // the mean sample time, and if it is over the budget the engines are compared on
+                // their first samples only
+                long long elapsed = getTimeNanoseconds() - bucketStart;
+                long long remaining = count - sample +
+                                      (long long)(enginesCount - engine - 1) * count;
+                if (sample > 0 && elapsed + elapsed / scored * remaining >
+                                  AUTO_BUCKET_BUDGET_NANOSECONDS)
+                {
+                    count = 1;
+                    break;
+                }
+                int first = samples[bucket][sample][0], second = samples[bucket][sample][1];
+                long long sampleStart = getTimeNanoseconds();
+                int score = scoreWithEngine(context, engine, first, second);
+                long long sampleTime = getTimeNanoseconds() - sampleStart;
+                firstTime = sample == 0 ? sampleTime : firstTime;
+                scored++;
+                if (engine == 0)
+                {
+                    storePairScore(context, first, second, score);
+                }
             }
-            else
+            long long time = getTimeNanoseconds() - start;
+            if (engine == 0 || time < bestTime)
             {
-                strncpy(sequencesNames[*numberOfSequencesAddress], row + 1, (size_t)rowLength - 1);
-                sequencesNames[*numberOfSequencesAddress][rowLength - 1] = '\0';
+                bestTime = time;
+                bestEngine = engine;
+            }
+            if (engine == 0 || firstTime < bestFirstTime)
+            {
+                bestFirstTime = firstTime;
+                bestFirstEngine = engine;
             }
-            startSequence = 1;
         }
-        else
+        context->planEngines[bucket] = count == samplesCount[bucket] ? bestEngine : bestFirstEngine;
+        calibrated[bucket] = 1;
+    }
+    // buckets without pairs to sample borrow the engine of the nearest calibrated bucket
+    for (int bucket = 0; bucket < AUTO_BUCKETS; bucket++)
+    {
+        int nearest = -1;
+        for (int distance = 0; nearest < 0 && distance < AUTO_BUCKETS; distance++)
         {
-            rowLength = deleteNewline(row);
-            if (startSequence)
+            if (bucket - distance >= 0 && calibrated[bucket - distance])
             {
-                sequences[*numberOfSequencesAddress] = (char *)malloc(
-                                                       (rowLength + 1) * sizeof(char));
-                if (sequences[*numberOfSequencesAddress] == NULL)
-                {
-                    fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
-                    freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
-                    freeSequencesMemory(sequences, *numberOfSequencesAddress);
-                    exit(EXIT_FAILURE);
-                }
-                strncpy(sequences[*numberOfSequencesAddress], row, rowLength * sizeof(char));
-                sequences[*numberOfSequencesAddress][rowLength] = '\0';
-                (*numberOfSequencesAddress)++;
-                startSequence = 0;
+                nearest = bucket - distance;
             }
-            else
+            else if (bucket + distance < AUTO_BUCKETS && calibrated[bucket + distance])
             {
-                sequenceLength = (int)strlen(sequences[*numberOfSequencesAddress - 1]);
-                temp = (char *)realloc(sequences[*numberOfSequencesAddress - 1],
-                        (sequenceLength + rowLength + 1) * sizeof(char));
-                if (temp == NULL)
-                {
-                    fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
-                    freeSequencesMemory(sequencesNames, *numberOfSequencesAddress);
-                    freeSequencesMemory(sequences, *numberOfSequencesAddress);
-                    exit(EXIT_FAILURE);
-                }
-                sequences[*numberOfSequencesAddress - 1] = temp;
-                strncpy(sequences[*numberOfSequencesAddress - 1] + sequenceLength, row,
-                        rowLength * sizeof(char));
-                sequences[*numberOfSequencesAddress - 1][sequenceLength + rowLength] = '\0';
+                nearest = bucket + distance;
             }
         }
+        if (!calibrated[bucket])
+        {
+            context->planEngines[bucket] = nearest < 0 ? ENGINE_TABLE :
+                                           context->planEngines[nearest];
+        }
     }
-    if (!feof(file))
+    char name[MAXIMAL_ENGINE_NAME_LENGTH];
+    long long cells = AUTO_FIRST_BUCKET_CELLS;
+    for (int bucket = 0; bucket < AUTO_BUCKETS; bucket++, cells *= AUTO_BUCKET_FACTOR)
     {
-        fprintf(stderr, "Error reading file\n");
-        freeSequencesMemory(sequences, *numberOfSequencesAddress);
-        exit(EXIT_FAILURE);
+        getEngineName(context->planEngines[bucket], name);
+        fprintf(stderr, bucket < AUTO_BUCKETS - 1 ? "Auto: pairs under %lld cells: %s%s\n" :
+                "Auto: pairs of %lld cells and more: %s%s\n",
+                bucket < AUTO_BUCKETS - 1 ? cells : cells / AUTO_BUCKET_FACTOR, name,
+                calibrated[bucket] ? "" : " (not sampled)");
     }
-    if (fclose(file))
+    if (fileName != NULL && saveEnginesPlan(context, fileName))
     {
-        fprintf(stderr, "Error closing file\n");
-        freeSequencesMemory(sequences, *numberOfSequencesAddress);
+        fprintf(stderr, "Error writing plan file\n");
+    }
+}
+
+int getPairBucket(long long cells)
+{
+    int bucket = 0;
+    for (long long limit = AUTO_FIRST_BUCKET_CELLS; bucket < AUTO_BUCKETS - 1 && cells >= limit;
+         limit *= AUTO_BUCKET_FACTOR)
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+int getEnginesCount(void)
+{
+    int count = ENGINE_FIRST_PROFILE;
+    while (count - ENGINE_FIRST_PROFILE < PROFILE_KERNEL_VARIANTS_COUNT &&
+           isProfileKernelSupported(count - ENGINE_FIRST_PROFILE))
+    {
+        count++;
+    }
+    return count;
+}
+
+void getEngineName(int engine, char *name)
+{
+    if (engine == ENGINE_TABLE)
+    {
+        strcpy(name, "table");
+    }
+    else if (engine == ENGINE_ROLLING_ROW)
+    {
+        strcpy(name, "rolling");
+    }
+    else
+    {
+        snprintf(name, MAXIMAL_ENGINE_NAME_LENGTH, "profile-%s",
+                 PROFILE_KERNEL_VARIANTS[engine - ENGINE_FIRST_PROFILE].name);
+    }
+}
+
+int scoreWithEngine(ComparisonContext *context, int engine, int first, int second)
+{
+    char *sequence1 = context->sequences[first], *sequence2 = context->sequences[second];
+    int length1 = context->lengths[first], length2 = context->lengths[second];
+    if (engine == ENGINE_TABLE)
+    {
+        return scoreTwoSequences(context->sequencesNames, context->sequences,
+                                 context->numberOfSequences, sequence1, sequence2,
+                                 context->m, context->s, context->g);
+    }
+    QueryProfile profile;
+    profile.length = length1;
+    profile.scores = NULL;
+    int *rows = (int *)trackedMalloc(2 * ((size_t)(length1 > length2 ? length1 : length2) + 1) *
+                                     sizeof(int), MEMORY_WORKSPACE);
+    if (rows != NULL && engine != ENGINE_ROLLING_ROW)
+    {
+        profile.scores = (int *)trackedMalloc(((size_t)context->alphabetSize * length1 + 1) *
+                                              sizeof(int), MEMORY_WORKSPACE);
+    }
+    if ((rows == NULL || (engine != ENGINE_ROLLING_ROW && profile.scores == NULL)) &&
+        flagWorkerFailure())
+    {
+        trackedFree(rows);
+        return 0;
+    }
+    if (rows == NULL || (engine != ENGINE_ROLLING_ROW && profile.scores == NULL))
+    {
+        fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
+        trackedFree(rows);
+        freeComparisonContext(context);
+        freeSequencesMemory(context->sequencesNames, context->numberOfSequences);
+        freeSequencesMemory(context->sequences, context->numberOfSequences);
         exit(EXIT_FAILURE);
     }
+    int score;
+    if (engine == ENGINE_ROLLING_ROW)
+    {
+        score = scoreWithRollingRow(sequence1, length1, sequence2, length2, context->m,
+                                    context->s, context->g, rows);
+    }
+    else
+    {
+        buildQueryProfile(sequence1, length1, context->residueCodes, context->alphabetSize,
+                          context->m, context->s, &profile);
+        score = PROFILE_KERNEL_VARIANTS[engine - ENGINE_FIRST_PROFILE].kernel(
+            &profile, sequence2, length2, context->residueCodes, context->g, rows);
+    }
+    trackedFree(profile.scores);
+    trackedFree(rows);
+    return score;
 }
 
-int deleteNewline(char *row)
+int loadEnginesPlan(ComparisonContext *context, const char *fileName)
 {
-    int rowLength = 0;
-    for (int i = 0; i < MAXIMAL_ROW_LENGTH - 1; i++)
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL)
     {
-        if (row[i] == '\n' || row[i] == '\r' || row[i] == EOF)
+        return -1;
+    }
+    char signature[MAXIMAL_ENGINE_NAME_LENGTH], name[MAXIMAL_ENGINE_NAME_LENGTH];
+    char engineName[MAXIMAL_ENGINE_NAME_LENGTH];
+    int m = 0, s = 0, g = 0;
+    unsigned long long inputHash = 0;
+    // a plan only holds for the widest engine, the weights and the input it was calibrated on
+    getEngineName(getEnginesCount() - 1, engineName);
+    int valid = fscanf(file, "%31s %31s %d %d %d %llx", signature, name, &m, &s, &g,
+                       &inputHash) == 6 && strcmp(signature, PLAN_SIGNATURE) == 0 &&
+                strcmp(name, engineName) == 0 && m == context->m && s == context->s &&
+                g == context->g && inputHash == (unsigned long long)hashInput(context);
+    for (int bucket = 0; valid && bucket < AUTO_BUCKETS; bucket++)
+    {
+        int fileBucket = -1;
+        valid = fscanf(file, "%d %31s", &fileBucket, name) == 2 && fileBucket == bucket;
+        int engine = 0, enginesCount = getEnginesCount();
+        for (; valid && engine < enginesCount; engine++)
         {
-            row[i] = '\0';
-            break;
+            getEngineName(engine, engineName);
+            if (strcmp(engineName, name) == 0)
+            {
+                break;
+            }
         }
-        rowLength++;
+        valid = valid && engine < enginesCount;
+        context->planEngines[bucket] = engine;
     }
-    return rowLength;
+    fclose(file);
+    return valid ? 0 : -1;
 }
 
-void compareSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
-                      int m, int s, int g)
+int saveEnginesPlan(const ComparisonContext *context, const char *fileName)
 {
-    for (int i = 0; i < numberOfSequences - 1; i++)
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL)
     {
-        for (int j = i + 1; j < numberOfSequences; j++)
-        {
-            compareTwoSequences(sequencesNames, sequences, numberOfSequences,
-                                sequencesNames[i], sequencesNames[j],
-                                sequences[i], sequences[j], m, s, g);
-        }
+        return -1;
+    }
+    char name[MAXIMAL_ENGINE_NAME_LENGTH];
+    getEngineName(getEnginesCount() - 1, name);
+    fprintf(file, "%s %s %d %d %d %016llx\n", PLAN_SIGNATURE, name, context->m, context->s,
+            context->g, (unsigned long long)hashInput(context));
+    for (int bucket = 0; bucket < AUTO_BUCKETS; bucket++)
+    {
+        getEngineName(context->planEngines[bucket], name);
+        fprintf(file, "%d %s\n", bucket, name);
     }
+    return fclose(file) == 0 ? 0 : -1;
 }
 
-void compareTwoSequences(char *sequencesNames[], char *sequences[], int numberOfSequences,
-                         char *sequence1Name, char *sequences2Name,
-                         char *sequence1, char *sequence2, int m, int s, int g)
+void compareTwoSequences(ComparisonContext *context, int first, int second)
 {
-    int tableRows = (int)strlen(sequence1) + 1, tableColumns = (int)strlen(sequence2) + 1;
-    int **table = NULL;
-    allocateTable(sequencesNames, sequences, numberOfSequences, &table, tableRows, tableColumns);
-    fillTable(sequence1, sequence2, table, tableRows, tableColumns, m, s, g);
-    printScore(table, tableRows, tableColumns, sequence1Name, sequences2Name);
-    freeTableMemory(table, tableRows);
+    // counted here rather than on lookup, as the tiled and parallel passes look the pairs up first
+    context->reusedPairs += isReusedPair(context, first, second);
+    long long mark = markPhase(context, PHASE_NONE, 0);
+    int score = scorePair(context, first, second);
+    if (!context->pairsJournaled)
+    {
+        journalPairScore(context, first, second, score, 0);
+    }
+    if (context->progressOnPrint)
+    {
+        countProgress(context, 1, (long long)context->lengths[first] * context->lengths[second], 0);
+    }
+    size_t key = (size_t)first * context->numberOfSequences + second;
+    context->pairScores[key] = score;
+    context->pairCompared[key] = 1;
+    if (context->pairStatistics != NULL && context->pairStatistics[key].source == PAIR_SOURCE_NONE)
+    {
+        context->pairStatistics[key].source = PAIR_SOURCE_MEMO;
+    }
+    mark = markPhase(context, PHASE_ALIGN, mark);
+    long long traceBegin = beginTrace();
+    printScore(score, context->sequencesNames[first], context->sequencesNames[second]);
+    endTrace("output", traceBegin, first, second);
+    mark = markPhase(context, PHASE_OUTPUT, mark);
+    if (context->options->alignment)
+    {
+        // the traceback is counted as alignment, though it prints as it goes
+        printAlignment(context, first, second);
+        markPhase(context, PHASE_ALIGN, mark);
+    }
 }
 
 void allocateTable(char *sequencesNames[], char *sequences[], int numberOfSequences,
                    int ***tableAddress, int tableRows, int tableColumns)
 {
-    *tableAddress = (int **)malloc(tableRows * sizeof(int *));
+    *tableAddress = (int **)trackedMalloc(tableRows * sizeof(int *), MEMORY_WORKSPACE);
+    if (*tableAddress == NULL && flagWorkerFailure())
+    {
+        return;
+    }
     if (*tableAddress == NULL)
     {
         fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
@@ -422,7 +7558,13 @@ void allocateTable(char *sequencesNames[], char *sequences[], int numberOfSequen
     }
     for (int i = 0; i < tableRows; i++)
     {
-        (*tableAddress)[i] = (int *)malloc(tableColumns * sizeof(int));
+        (*tableAddress)[i] = (int *)trackedMalloc(tableColumns * sizeof(int), MEMORY_WORKSPACE);
+        if ((*tableAddress)[i] == NULL && flagWorkerFailure())
+        {
+            freeTableMemory(*tableAddress, i);
+            *tableAddress = NULL;
+            return;
+        }
         if ((*tableAddress)[i] == NULL)
         {
             fprintf(stderr, MEMORY_ALLOCATION_FAILED_MESSAGE);
@@ -506,22 +7648,30 @@ int max(int n1, int n2)
     return n2;
 }
 
-void printScore(int **table, int tableRows, int tableColumns,
-                char *sequence1Name, char *sequence2Name)
+void printScore(int score, char *sequence1Name, char *sequence2Name)
 {
-    int score = table[tableRows - 1][tableColumns - 1];
     printf("Score for alignment of %s to %s is %d\n",
            sequence1Name, sequence2Name, score);
 }
 
+int flagWorkerFailure(void)
+{
+    if (threadSlot == 0)
+    {
+        return 0;
+    }
+    __atomic_store_n(&workerFailed, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
 void freeTableMemory(int **table, int tableRows)
 {
     for (int i = 0; i < tableRows; i++)
     {
-        free(table[i]);
+        trackedFree(table[i]);
         table[i] = NULL;
     }
-    free(table);
+    trackedFree(table);
     table = NULL;
 }
 
@@ -529,7 +7679,7 @@ void freeSequencesMemory(char *sequences[], int numberOfSequences)
 {
     for (int i = 0; i < numberOfSequences; i++)
     {
-        free(sequences[i]);
+        trackedFree(sequences[i]);
         sequences[i] = NULL;
     }
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+/**
+ * @file aligner.c
+ * @brief Test of the alignment library: the scores of random pairs, scored one by one and in
+ * batches (with runs of pairs sharing their first sequence), are compared to the full dynamic
+ * programming table, with every profile kernel the CPU supports, and the errors are checked.
+ */
+
+// ------------------------------------------- includes -------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "SequencesAligner.h"
+#include "SequencesAlignerInternal.h"
+
+// -------------------------------------------- defines -------------------------------------------
+#define SEQUENCES_COUNT 24
+#define MAXIMAL_LENGTH 300
+#define PREALLOCATED_LENGTH 64
+#define RUN_LENGTH 5
+#define WEIGHTS_COUNT 3
+#define RESIDUES "ACGTN"
+#define RESIDUES_COUNT 5
+#define GENERATOR_MULTIPLIER 6364136223846793005ULL
+#define GENERATOR_INCREMENT 1442695040888963407ULL
+#define GENERATOR_SHIFT 33
+
+// ------------------------------------------- constants ------------------------------------------
+/**
+ * @brief The match, mismatch and gap weights tested.
+ */
+const int WEIGHTS[WEIGHTS_COUNT][3] = {{1, -1, -2}, {2, -3, -1}, {-1, 1, -3}};
+
+// -------------------------------------- functions declaration -----------------------------------
+/**
+ * @brief A function that scores two sequences with the full dynamic programming table.
+ * @param first The first sequence.
+ * @param second The second sequence.
+ * @param weights The match, mismatch and gap weights.
+ * @return The score of the alignment.
+ */
+int scoreWithTable(SequenceSpan first, SequenceSpan second, const int weights[3]);
+/**
+ * @brief A function that tests an aligner of a kernel against the table scores.
+ * @param isaName The instruction set of the kernel.
+ * @param sequences The sequences.
+ * @param weights The match, mismatch and gap weights.
+ * @return The number of failures.
+ */
+int testKernel(const char *isaName, const SequenceSpan sequences[], const int weights[3]);
+/**
+ * @brief A function that tests that invalid arguments are reported as errors.
+ * @return The number of failures.
+ */
+int testErrors(void);
+
+/**
+ * @brief The main function of the test.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+int main(void)
+{
+    static char residues[SEQUENCES_COUNT][MAXIMAL_LENGTH];
+    SequenceSpan sequences[SEQUENCES_COUNT];
+    uint64_t state = 1;
+    for (int i = 0; i < SEQUENCES_COUNT; i++)
+    {
+        // an empty sequence, and a sequence longer than the preallocated workspace
+        int length = i == 0 ? 0 : i == 1 ? MAXIMAL_LENGTH : 1 + i * 7 % (MAXIMAL_LENGTH / 3);
+        for (int j = 0; j < length; j++)
+        {
+            state = state * GENERATOR_MULTIPLIER + GENERATOR_INCREMENT;
+            residues[i][j] = RESIDUES[(state >> GENERATOR_SHIFT) % RESIDUES_COUNT];
+        }
+        sequences[i].residues = length > 0 ? residues[i] : NULL;
+        sequences[i].length = length;
+    }
+    int failures = testErrors();
+    for (int variant = 0; variant < PROFILE_KERNEL_VARIANTS_COUNT; variant++)
+    {
+        for (int weights = 0; isProfileKernelSupported(variant) && weights < WEIGHTS_COUNT;
+             weights++)
+        {
+            failures += testKernel(PROFILE_KERNEL_VARIANTS[variant].name, sequences,
+                                   WEIGHTS[weights]);
+        }
+    }
+    if (failures > 0)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
+
+int scoreWithTable(SequenceSpan first, SequenceSpan second, const int weights[3])
+{
+    int columns = second.length + 1;
+    int *table = (int *)malloc((size_t)(first.length + 1) * columns * sizeof(int));
+    if (table == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i <= first.length; i++)
+    {
+        for (int j = 0; j <= second.length; j++)
+        {
+            int score = (i + j) * weights[2];
+            if (i > 0 && j > 0)
+            {
+                int diagonal = table[(i - 1) * columns + j - 1] +
+                               (first.residues[i - 1] == second.residues[j - 1] ? weights[0]
+                                                                                : weights[1]);
+                int up = table[(i - 1) * columns + j] + weights[2];
+                int left = table[i * columns + j - 1] + weights[2];
+                score = diagonal > up ? diagonal : up;
+                score = score > left ? score : left;
+            }
+            table[i * columns + j] = score;
+        }
+    }
+    int score = table[first.length * columns + second.length];
+    free(table);
+    return score;
+}
+
+int testKernel(const char *isaName, const SequenceSpan sequences[], const int weights[3])
+{
+    SequencesAligner *aligner = NULL;
+    int error = createSequencesAligner(weights[0], weights[1], weights[2], isaName,
+                                       PREALLOCATED_LENGTH, &aligner);
+    if (error != ALIGNER_SUCCESS)
+    {
+        printf("%s: %s\n", isaName, getAlignerErrorMessage(error));
+        return 1;
+    }
+    // every pair once, in runs of RUN_LENGTH pairs sharing their first sequence
+    static SequencePair pairs[SEQUENCES_COUNT * SEQUENCES_COUNT];
+    static int scores[SEQUENCES_COUNT * SEQUENCES_COUNT];
+    int pairsCount = 0, failures = 0;
+    for (int first = 0; first < SEQUENCES_COUNT; first++)
+    {
+        for (int second = 0; second < SEQUENCES_COUNT; second++)
+        {
+            pairs[pairsCount].first = sequences[first];
+            pairs[pairsCount].second = sequences[second];
+            pairsCount++;
+        }
+    }
+    for (int start = 0; start < pairsCount; start += RUN_LENGTH)
+    {
+        int count = pairsCount - start < RUN_LENGTH ? pairsCount - start : RUN_LENGTH;
+        error = scoreSequencesPairs(aligner, pairs + start, count, scores + start);
+        failures += error != ALIGNER_SUCCESS;
+    }
+    for (int pair = 0; pair < pairsCount; pair++)
+    {
+        int expected = scoreWithTable(pairs[pair].first, pairs[pair].second, weights);
+        int single = 0;
+        error = scoreSequencesPair(aligner, pairs[pair].first, pairs[pair].second, &single);
+        if (error != ALIGNER_SUCCESS || scores[pair] != expected || single != expected)
+        {
+            printf("%s: pair %d (lengths %d and %d) scored %d and %d instead of %d\n", isaName,
+                   pair, pairs[pair].first.length, pairs[pair].second.length, scores[pair],
+                   single, expected);
+            failures++;
+        }
+    }
+    freeSequencesAligner(aligner);
+    return failures;
+}
+
+int testErrors(void)
+{
+    SequencesAligner *aligner = NULL;
+    int failures = 0, score = 0;
+    failures += createSequencesAligner(1, -1, -2, "no-such-isa", 0, &aligner) !=
+                ALIGNER_UNSUPPORTED_ISA || aligner != NULL;
+    failures += createSequencesAligner(1, -1, -2, NULL, -1, &aligner) !=
+                ALIGNER_INVALID_ARGUMENT;
+    if (createSequencesAligner(1, -1, -2, NULL, 0, &aligner) != ALIGNER_SUCCESS)
+    {
+        return failures + 1;
+    }
+    SequenceSpan valid = {"ACGT", 4}, negative = {"ACGT", -1}, missing = {NULL, 3};
+    failures += scoreSequencesPair(aligner, valid, negative, &score) != ALIGNER_INVALID_ARGUMENT;
+    failures += scoreSequencesPair(aligner, missing, valid, &score) != ALIGNER_INVALID_ARGUMENT;
+    failures += scoreSequencesPairs(aligner, NULL, 1, &score) != ALIGNER_INVALID_ARGUMENT;
+    failures += scoreSequencesPairs(aligner, NULL, 0, NULL) != ALIGNER_SUCCESS;
+    freeSequencesAligner(aligner);
+    if (failures > 0)
+    {
+        printf("%d error checks failed\n", failures);
+    }
+    return failures;
+}
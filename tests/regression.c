@@ -0,0 +1,541 @@
+/**
+ * @file regression.c
+ * @brief Regression runner of the sequences comparison program. The runner runs every case of
+ * tests/weights (tests/testN with the weights the school solution was run with) and compares the
+ * output to solutions/school_N, runs a few large generated cases, and measures the time and the
+ * peak memory of every case. The measurements are kept in a JSON baseline: without a baseline (or
+ * with --update) the runner records one, and otherwise it fails when a case is slower or takes
+ * more memory than the baseline by more than the threshold, or when its output changed. A case
+ * missing from the baseline is reported, to record the baseline again.
+ */
+
+// ------------------------------------------- includes -------------------------------------------
+#define _POSIX_C_SOURCE 200809L
+// for wait4, which returns the resource usage of the child
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// -------------------------------------------- defines -------------------------------------------
+#define MAXIMAL_CASES 64
+#define MAXIMAL_CASE_ARGUMENTS 8
+#define MAXIMAL_NAME_LENGTH 64
+#define MAXIMAL_LINE_LENGTH 512
+#define DEFAULT_THRESHOLD_PERCENT 25
+#define DEFAULT_REPETITIONS 3
+#define PERCENT 100.0
+#define NANOSECONDS_IN_SECOND 1000000000.0
+#define MICROSECONDS_IN_SECOND 1000000.0
+#define MINIMAL_TIME_REGRESSION_SECONDS 0.05
+#define MINIMAL_MEMORY_REGRESSION_KILOBYTES 2048
+#define OUTPUT_HASH_SEED 0xcbf29ce484222325ULL
+#define OUTPUT_HASH_PRIME 0x100000001b3ULL
+#define GENERATOR_MULTIPLIER 6364136223846793005ULL
+#define GENERATOR_INCREMENT 1442695040888963407ULL
+#define GENERATOR_SHIFT 33
+#define RESIDUES "ACGT"
+#define RESIDUES_COUNT 4
+#define FASTA_LINE_LENGTH 60
+#define TEMPORARY_DIRECTORY_TEMPLATE "/tmp/02n-regression-XXXXXX"
+#define USAGE_MESSAGE "Usage: regression <program> <repository> <baseline.json> [--update] " \
+                      "[--threshold PERCENT] [--repetitions N]\n"
+
+// ---------------------------------------- types definition --------------------------------------
+/**
+ * @brief A case of the regression run: a run of the program, its expected output if it is known,
+ * and its measurements.
+ */
+typedef struct RegressionCase
+{
+    /** The name of the case, as written in the baseline. */
+    char name[MAXIMAL_NAME_LENGTH];
+    /** The sequences file. */
+    char inputPath[MAXIMAL_LINE_LENGTH];
+    /** The file of the expected output, or an empty string if only the baseline knows it. */
+    char expectedPath[MAXIMAL_LINE_LENGTH];
+    /** The match, mismatch and gap weights. */
+    char weights[3][MAXIMAL_NAME_LENGTH];
+    /** The shortest wall time of the repetitions, in seconds. */
+    double seconds;
+    /** The user and system time of that repetition, in seconds. */
+    double cpuSeconds;
+    /** The largest peak resident set size of the repetitions, in kilobytes. */
+    long maximalResidentKilobytes;
+    /** The hash of the output (stdout and stderr, as the tester redirects both). */
+    uint64_t outputHash;
+} RegressionCase;
+
+/**
+ * @brief A generated case: sequences of random residues.
+ */
+typedef struct GeneratedCase
+{
+    /** The name of the case. */
+    const char *name;
+    /** The number of sequences. */
+    int sequencesCount;
+    /** The length of every sequence. */
+    int length;
+    /** The seed of the residues. */
+    uint64_t seed;
+} GeneratedCase;
+
+// ------------------------------------------- constants ------------------------------------------
+/**
+ * @brief The generated cases: many pairs of short sequences, and one pair whose table is large.
+ */
+const GeneratedCase GENERATED_CASES[] = {
+    {"large-100x200", 100, 200, 1},
+    {"large-2x5000", 2, 5000, 2},
+};
+const int GENERATED_CASES_COUNT = (int)(sizeof(GENERATED_CASES) / sizeof(GENERATED_CASES[0]));
+/**
+ * @brief The weights of the generated cases.
+ */
+const char *const GENERATED_WEIGHTS[3] = {"2", "-1", "-2"};
+
+// -------------------------------------- functions declaration -----------------------------------
+/**
+ * @brief A function that reads the cases of tests/weights: a line per test, with its number and
+ * its match, mismatch and gap weights (lines starting with '#' are comments).
+ * @param repository The path of the repository.
+ * @param cases The array to add the cases to.
+ * @param casesCount The number of cases, updated.
+ * @return 0 on success, -1 if the file can't be read or is invalid.
+ */
+int readTestCases(const char *repository, RegressionCase cases[], int *casesCount);
+/**
+ * @brief A function that writes the generated cases into a directory, and adds them.
+ * @param directory The directory.
+ * @param cases The array to add the cases to.
+ * @param casesCount The number of cases, updated.
+ * @return 0 on success, -1 if a file can't be written.
+ */
+int generateCases(const char *directory, RegressionCase cases[], int *casesCount);
+/**
+ * @brief A function that runs the program on a case, with its stdout and stderr redirected to a
+ * file, and measures the run with wait4.
+ * @param program The path of the program.
+ * @param testCase The case.
+ * @param outputPath The file to write the output to.
+ * @param seconds The wall time of the run, in seconds.
+ * @param cpuSeconds The user and system time of the run, in seconds.
+ * @param residentKilobytes The peak resident set size of the run, in kilobytes.
+ * @return 0 if the program ran, -1 if it couldn't be started or was killed by a signal.
+ */
+int runCase(const char *program, const RegressionCase *testCase, const char *outputPath,
+            double *seconds, double *cpuSeconds, long *residentKilobytes);
+/**
+ * @brief A function that hashes a file (FNV-1a).
+ * @param path The path of the file.
+ * @param hash The hash.
+ * @return 0 on success, -1 if the file can't be read.
+ */
+int hashFile(const char *path, uint64_t *hash);
+/**
+ * @brief A function that reads the cases of a baseline.
+ * @param path The path of the baseline.
+ * @param cases The array to read the cases to.
+ * @param casesCount The number of cases read.
+ * @return 0 on success, -1 if the baseline can't be read.
+ */
+int readBaseline(const char *path, RegressionCase cases[], int *casesCount);
+/**
+ * @brief A function that writes the cases to a baseline.
+ * @param path The path of the baseline.
+ * @param cases The cases.
+ * @param casesCount The number of cases.
+ * @return 0 on success, -1 if the baseline can't be written.
+ */
+int writeBaseline(const char *path, const RegressionCase cases[], int casesCount);
+/**
+ * @brief A function that compares a case to its baseline, and prints the regressions.
+ * @param testCase The case.
+ * @param baseline The case in the baseline.
+ * @param threshold The threshold of the regressions, in percents.
+ * @return The number of regressions.
+ */
+int compareToBaseline(const RegressionCase *testCase, const RegressionCase *baseline,
+                      int threshold);
+/**
+ * @brief A function that returns the time of a monotonic clock in nanoseconds.
+ * @return The time in nanoseconds.
+ */
+long long getTimeNanoseconds(void);
+
+/**
+ * @brief The main function of the runner. It runs every case, checks the outputs, and records or
+ * compares the baseline.
+ * @param argc The number of program arguments.
+ * @param argv The program arguments.
+ * @return 0 if every case passed, 1 otherwise.
+ */
+int main(int argc, char *argv[])
+{
+    int update = 0, threshold = DEFAULT_THRESHOLD_PERCENT, repetitions = DEFAULT_REPETITIONS;
+    char *positional[3];
+    int positionalCount = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+        {
+            update = 1;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            repetitions = atoi(argv[++i]);
+        }
+        else if (positionalCount < 3 && strncmp(argv[i], "--", 2) != 0)
+        {
+            positional[positionalCount++] = argv[i];
+        }
+        else
+        {
+            positionalCount = -1;
+            break;
+        }
+    }
+    if (positionalCount != 3 || threshold <= 0 || repetitions <= 0)
+    {
+        fprintf(stderr, USAGE_MESSAGE);
+        return 1;
+    }
+    const char *program = positional[0], *repository = positional[1];
+    const char *baselinePath = positional[2];
+    static RegressionCase cases[MAXIMAL_CASES], baseline[MAXIMAL_CASES];
+    int casesCount = 0, baselineCount = 0;
+    char directory[] = TEMPORARY_DIRECTORY_TEMPLATE;
+    if (readTestCases(repository, cases, &casesCount))
+    {
+        fprintf(stderr, "Error reading %s/tests/weights\n", repository);
+        return 1;
+    }
+    if (mkdtemp(directory) == NULL || generateCases(directory, cases, &casesCount))
+    {
+        fprintf(stderr, "Error writing the generated cases\n");
+        return 1;
+    }
+    int hasBaseline = !update && readBaseline(baselinePath, baseline, &baselineCount) == 0;
+    char outputPath[MAXIMAL_LINE_LENGTH];
+    snprintf(outputPath, sizeof(outputPath), "%s/output", directory);
+    int failures = 0;
+    for (int i = 0; i < casesCount; i++)
+    {
+        RegressionCase *testCase = &cases[i];
+        testCase->seconds = 0;
+        testCase->maximalResidentKilobytes = 0;
+        int failed = 0;
+        for (int repetition = 0; !failed && repetition < repetitions; repetition++)
+        {
+            double seconds = 0, cpuSeconds = 0;
+            long residentKilobytes = 0;
+            failed = runCase(program, testCase, outputPath, &seconds, &cpuSeconds,
+                             &residentKilobytes) || hashFile(outputPath, &testCase->outputHash);
+            // the shortest time is the least disturbed by the rest of the machine
+            if (repetition == 0 || seconds < testCase->seconds)
+            {
+                testCase->seconds = seconds;
+                testCase->cpuSeconds = cpuSeconds;
+            }
+            if (residentKilobytes > testCase->maximalResidentKilobytes)
+            {
+                testCase->maximalResidentKilobytes = residentKilobytes;
+            }
+        }
+        uint64_t expectedHash = 0;
+        if (!failed && testCase->expectedPath[0] != '\0' &&
+            (hashFile(testCase->expectedPath, &expectedHash) ||
+             expectedHash != testCase->outputHash))
+        {
+            fprintf(stderr, "%s: the output differs from %s\n", testCase->name,
+                    testCase->expectedPath);
+            failed = 1;
+        }
+        int inBaseline = 0;
+        for (int j = 0; !failed && hasBaseline && j < baselineCount; j++)
+        {
+            if (strcmp(baseline[j].name, testCase->name) == 0)
+            {
+                failed = compareToBaseline(testCase, &baseline[j], threshold) > 0;
+                inBaseline = 1;
+            }
+        }
+        // a case added or renamed since the baseline was recorded has nothing to be compared to
+        if (!failed && hasBaseline && !inBaseline)
+        {
+            fprintf(stderr, "%s: not in the baseline %s, record it again with the "
+                    "regression-baseline target\n", testCase->name, baselinePath);
+        }
+        printf("%-14s %s %9.4f s %9.4f s CPU %8ld KB\n", testCase->name,
+               failed ? "FAIL" : "PASS", testCase->seconds, testCase->cpuSeconds,
+               testCase->maximalResidentKilobytes);
+        failures += failed;
+    }
+    for (int i = 0; i < casesCount; i++)
+    {
+        // only the generated cases are in the temporary directory
+        if (cases[i].expectedPath[0] == '\0')
+        {
+            unlink(cases[i].inputPath);
+        }
+    }
+    unlink(outputPath);
+    rmdir(directory);
+    if (failures > 0)
+    {
+        printf("%d of %d cases failed\n", failures, casesCount);
+        return 1;
+    }
+    if (!hasBaseline)
+    {
+        if (writeBaseline(baselinePath, cases, casesCount))
+        {
+            fprintf(stderr, "Error writing the baseline %s\n", baselinePath);
+            return 1;
+        }
+        printf("Recorded the baseline %s\n", baselinePath);
+    }
+    printf("All %d cases passed\n", casesCount);
+    return 0;
+}
+
+int readTestCases(const char *repository, RegressionCase cases[], int *casesCount)
+{
+    char path[MAXIMAL_LINE_LENGTH], line[MAXIMAL_LINE_LENGTH];
+    snprintf(path, sizeof(path), "%s/tests/weights", repository);
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    int valid = 1;
+    while (valid && fgets(line, sizeof(line), file) != NULL)
+    {
+        int test = 0;
+        RegressionCase *testCase = &cases[*casesCount];
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+        valid = *casesCount < MAXIMAL_CASES &&
+                sscanf(line, "%d %63s %63s %63s", &test, testCase->weights[0],
+                       testCase->weights[1], testCase->weights[2]) == 4;
+        if (valid)
+        {
+            snprintf(testCase->name, sizeof(testCase->name), "test%d", test);
+            snprintf(testCase->inputPath, sizeof(testCase->inputPath), "%s/tests/test%d",
+                     repository, test);
+            snprintf(testCase->expectedPath, sizeof(testCase->expectedPath),
+                     "%s/solutions/school_%d", repository, test);
+            (*casesCount)++;
+        }
+    }
+    fclose(file);
+    return valid ? 0 : -1;
+}
+
+int generateCases(const char *directory, RegressionCase cases[], int *casesCount)
+{
+    for (int i = 0; i < GENERATED_CASES_COUNT; i++)
+    {
+        const GeneratedCase *generated = &GENERATED_CASES[i];
+        if (*casesCount == MAXIMAL_CASES)
+        {
+            return -1;
+        }
+        RegressionCase *testCase = &cases[(*casesCount)++];
+        snprintf(testCase->name, sizeof(testCase->name), "%s", generated->name);
+        snprintf(testCase->inputPath, sizeof(testCase->inputPath), "%s/%s.fa", directory,
+                 generated->name);
+        testCase->expectedPath[0] = '\0';
+        for (int weight = 0; weight < 3; weight++)
+        {
+            snprintf(testCase->weights[weight], sizeof(testCase->weights[weight]), "%s",
+                     GENERATED_WEIGHTS[weight]);
+        }
+        FILE *file = fopen(testCase->inputPath, "w");
+        if (file == NULL)
+        {
+            return -1;
+        }
+        // a fixed generator, so the cases (and their outputs) are the same on every run
+        uint64_t state = generated->seed;
+        for (int sequence = 0; sequence < generated->sequencesCount; sequence++)
+        {
+            fprintf(file, ">seq%d\n", sequence + 1);
+            for (int position = 0; position < generated->length; position++)
+            {
+                state = state * GENERATOR_MULTIPLIER + GENERATOR_INCREMENT;
+                fputc(RESIDUES[(state >> GENERATOR_SHIFT) % RESIDUES_COUNT], file);
+                if ((position + 1) % FASTA_LINE_LENGTH == 0 || position + 1 == generated->length)
+                {
+                    fputc('\n', file);
+                }
+            }
+        }
+        if (fclose(file))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int runCase(const char *program, const RegressionCase *testCase, const char *outputPath,
+            double *seconds, double *cpuSeconds, long *residentKilobytes)
+{
+    char *arguments[MAXIMAL_CASE_ARGUMENTS] = {(char *)program, (char *)testCase->inputPath,
+                                               (char *)testCase->weights[0],
+                                               (char *)testCase->weights[1],
+                                               (char *)testCase->weights[2], NULL};
+    long long start = getTimeNanoseconds();
+    pid_t child = fork();
+    if (child < 0)
+    {
+        return -1;
+    }
+    if (child == 0)
+    {
+        int output = open(outputPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if (output < 0 || dup2(output, STDOUT_FILENO) < 0 || dup2(output, STDERR_FILENO) < 0)
+        {
+            _exit(EXIT_FAILURE);
+        }
+        close(output);
+        execv(program, arguments);
+        _exit(EXIT_FAILURE);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child)
+    {
+        return -1;
+    }
+    *seconds = (getTimeNanoseconds() - start) / NANOSECONDS_IN_SECOND;
+    *cpuSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / MICROSECONDS_IN_SECOND +
+                  usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / MICROSECONDS_IN_SECOND;
+    *residentKilobytes = usage.ru_maxrss;
+    // the program's own exit code is part of its output for the tester, so only signals fail here
+    if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "%s: killed by signal %d\n", testCase->name, WTERMSIG(status));
+        return -1;
+    }
+    return 0;
+}
+
+int hashFile(const char *path, uint64_t *hash)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    *hash = OUTPUT_HASH_SEED;
+    int character = 0;
+    while ((character = fgetc(file)) != EOF)
+    {
+        *hash = (*hash ^ (unsigned char)character) * OUTPUT_HASH_PRIME;
+    }
+    fclose(file);
+    return 0;
+}
+
+int readBaseline(const char *path, RegressionCase cases[], int *casesCount)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    char line[MAXIMAL_LINE_LENGTH];
+    *casesCount = 0;
+    // the baseline is read back line by line, in the layout writeBaseline writes
+    while (fgets(line, sizeof(line), file) != NULL && *casesCount < MAXIMAL_CASES)
+    {
+        RegressionCase *testCase = &cases[*casesCount];
+        unsigned long long hash = 0;
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"seconds\": %lf, \"cpu_seconds\": %lf, "
+                   "\"max_rss_kb\": %ld, \"output_hash\": \"%llx\"}", testCase->name,
+                   &testCase->seconds, &testCase->cpuSeconds,
+                   &testCase->maximalResidentKilobytes, &hash) == 5)
+        {
+            testCase->outputHash = (uint64_t)hash;
+            (*casesCount)++;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+int writeBaseline(const char *path, const RegressionCase cases[], int casesCount)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    // the threshold is given to every run, so only the measurements are recorded
+    fprintf(file, "{\n  \"cases\": [\n");
+    for (int i = 0; i < casesCount; i++)
+    {
+        fprintf(file, "    {\"name\": \"%s\", \"seconds\": %.6f, \"cpu_seconds\": %.6f, "
+                "\"max_rss_kb\": %ld, \"output_hash\": \"%016llx\"}%s\n", cases[i].name,
+                cases[i].seconds, cases[i].cpuSeconds, cases[i].maximalResidentKilobytes,
+                (unsigned long long)cases[i].outputHash, i + 1 < casesCount ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+int compareToBaseline(const RegressionCase *testCase, const RegressionCase *baseline,
+                      int threshold)
+{
+    int regressions = 0;
+    double factor = 1 + threshold / PERCENT;
+    if (testCase->outputHash != baseline->outputHash)
+    {
+        fprintf(stderr, "%s: the output differs from the baseline\n", testCase->name);
+        regressions++;
+    }
+    // tiny differences are noise however large they are relatively
+    if (testCase->seconds > baseline->seconds * factor &&
+        testCase->seconds - baseline->seconds > MINIMAL_TIME_REGRESSION_SECONDS)
+    {
+        fprintf(stderr, "%s: %.4f s, the baseline is %.4f s (+%.1f%%)\n", testCase->name,
+                testCase->seconds, baseline->seconds,
+                PERCENT * (testCase->seconds / baseline->seconds - 1));
+        regressions++;
+    }
+    if (testCase->maximalResidentKilobytes > baseline->maximalResidentKilobytes * factor &&
+        testCase->maximalResidentKilobytes - baseline->maximalResidentKilobytes >
+        MINIMAL_MEMORY_REGRESSION_KILOBYTES)
+    {
+        fprintf(stderr, "%s: %ld KB, the baseline is %ld KB (+%.1f%%)\n", testCase->name,
+                testCase->maximalResidentKilobytes, baseline->maximalResidentKilobytes,
+                PERCENT * ((double)testCase->maximalResidentKilobytes /
+                           baseline->maximalResidentKilobytes - 1));
+        regressions++;
+    }
+    return regressions;
+}
+
+long long getTimeNanoseconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long long)time.tv_sec * (long long)NANOSECONDS_IN_SECOND + time.tv_nsec;
+}